@@ -0,0 +1,121 @@
+// Enemy movement as the game used to do it, one fat Sprite at a time, against
+// the structure-of-arrays kernels in src/entity_store.cpp. Both integrate,
+// bounce off the screen edges and sync the int rects. A few entities are wider
+// than the screen so the vector and scalar clamps are checked against each other.
+//
+//   make -f Makefile.host bench
+
+#include "../src/entity_store.h"
+#include <stdio.h>
+#include <vector>
+
+const int FRAMES = 200;
+
+static Sprite makeSprite(int i)
+{
+    Sprite sprite = {};
+    sprite.fx = static_cast<float>((i * 37) % SCREEN_WIDTH);
+    sprite.fy = static_cast<float>((i * 53) % SCREEN_HEIGHT);
+    sprite.hv = 120.0f + i % 120;
+    sprite.vv = -120.0f - i % 90;
+    sprite.bounds = {static_cast<int>(sprite.fx), static_cast<int>(sprite.fy), 30, 30};
+    if (i % 1000 == 7)
+    {
+        sprite.bounds.w = SCREEN_WIDTH + 64;
+        sprite.bounds.h = SCREEN_HEIGHT + 64;
+    }
+    sprite.angle = 0.0f;
+    return sprite;
+}
+
+// The loop from before the entity store, minus the per-mode extras
+static void updateSprites(std::vector<Sprite> &sprites, float deltaTime)
+{
+    for (auto &enemy : sprites)
+    {
+        enemy.fx += enemy.hv * deltaTime;
+        enemy.fy += enemy.vv * deltaTime;
+
+        if (enemy.fx < 0)
+        {
+            enemy.fx = 0;
+            enemy.hv *= -1;
+        }
+        else if (enemy.fx > SCREEN_WIDTH - enemy.bounds.w)
+        {
+            enemy.fx = SCREEN_WIDTH - enemy.bounds.w;
+            enemy.hv *= -1;
+        }
+        if (enemy.fy < 0)
+        {
+            enemy.fy = 0;
+            enemy.vv *= -1;
+        }
+        else if (enemy.fy > SCREEN_HEIGHT - enemy.bounds.h)
+        {
+            enemy.fy = SCREEN_HEIGHT - enemy.bounds.h;
+            enemy.vv *= -1;
+        }
+
+        enemy.bounds.x = static_cast<int>(enemy.fx);
+        enemy.bounds.y = static_cast<int>(enemy.fy);
+    }
+}
+
+static double millisecondsPerFrame(Uint64 start)
+{
+    return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / FRAMES;
+}
+
+int main()
+{
+    const int counts[] = {1000, 10000, 100000};
+    int mismatches = 0;
+
+    printf("%8s %14s %14s %10s\n", "entities", "AoS ms/frame", "SoA ms/frame", "speedup");
+    for (int count : counts)
+    {
+        std::vector<Sprite> sprites;
+        EntityStore store;
+        reserveEntities(store, count);
+        for (int i = 0; i < count; i++)
+        {
+            sprites.push_back(makeSprite(i));
+            addEntity(store, sprites.back());
+        }
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            updateSprites(sprites, SIM_TICK);
+        }
+        double aos = millisecondsPerFrame(start);
+
+        start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            integrateEntities(store, SIM_TICK);
+            constrainEntities(store, SCREEN_WIDTH, SCREEN_HEIGHT);
+        }
+        double soa = millisecondsPerFrame(start);
+
+        for (int i = 0; i < count; i++)
+        {
+            const Sprite &sprite = sprites[i];
+            if (sprite.fx != store.fx[i] || sprite.fy != store.fy[i] || sprite.hv != store.hv[i] || sprite.vv != store.vv[i] ||
+                sprite.bounds.x != store.x[i] || sprite.bounds.y != store.y[i])
+            {
+                mismatches++;
+            }
+        }
+
+        printf("%8d %14.3f %14.3f %9.1fx\n", count, aos, soa, aos / soa);
+    }
+
+    if (mismatches > 0)
+    {
+        printf("FAILED: %d entities ended up somewhere else than with the scalar loop\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Enemy update split across the job system at different worker counts. Each
+// chunk integrates its enemies, pulls them towards the nearest of a few tokens
+// like the attract mode does, and bounces them off the screen edges. Every run
+// has to end up exactly where the single-threaded one did.
+//
+//   make -f Makefile.host bench
+
+#include "../src/entity_store.h"
+#include "../src/job_system.h"
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+const int FRAMES = 100;
+const int TOKENS = 16;
+const int CHUNK = 256; // ENEMY_JOB_CHUNK in src/enemy_update.h
+
+struct Token
+{
+    float x;
+    float y;
+};
+
+static void fillStore(EntityStore &store, int count)
+{
+    clearEntities(store);
+    reserveEntities(store, count);
+    for (int i = 0; i < count; i++)
+    {
+        Sprite sprite = {};
+        sprite.fx = static_cast<float>((i * 37) % SCREEN_WIDTH);
+        sprite.fy = static_cast<float>((i * 53) % SCREEN_HEIGHT);
+        sprite.hv = 120.0f + i % 120;
+        sprite.vv = -120.0f - i % 90;
+        sprite.bounds = {static_cast<int>(sprite.fx), static_cast<int>(sprite.fy), 30, 30};
+        sprite.angle = 0.0f;
+        addEntity(store, sprite);
+    }
+}
+
+// Nudge every enemy in [begin, end) towards its nearest token
+static void attractEnemies(EntityStore &store, const Token *tokens, int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        float bestX = 0.0f;
+        float bestY = 0.0f;
+        float bestDistance = 1e30f;
+        for (int t = 0; t < TOKENS; t++)
+        {
+            float dx = tokens[t].x - store.fx[i];
+            float dy = tokens[t].y - store.fy[i];
+            float distance = dx * dx + dy * dy;
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                bestX = dx;
+                bestY = dy;
+            }
+        }
+        store.hv[i] += bestX * 0.01f;
+        store.vv[i] += bestY * 0.01f;
+    }
+}
+
+static double runFrames(EntityStore &store, const Token *tokens)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        parallelFor(store.count, CHUNK, [&](int begin, int end) {
+            integrateEntities(store, SIM_TICK, begin, end);
+            attractEnemies(store, tokens, begin, end);
+            constrainEntities(store, SCREEN_WIDTH, SCREEN_HEIGHT, begin, end);
+        });
+    }
+    return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / FRAMES;
+}
+
+int main()
+{
+    const int counts[] = {1000, 10000, 100000};
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    // 2 extra workers is the Wii U's three cores
+    std::vector<int> workerCounts = {0, 1, 2};
+    if (cores - 1 > 2)
+    {
+        workerCounts.push_back(cores - 1);
+    }
+
+    Token tokens[TOKENS];
+    for (int t = 0; t < TOKENS; t++)
+    {
+        tokens[t] = {static_cast<float>((t * 131) % SCREEN_WIDTH), static_cast<float>((t * 97) % SCREEN_HEIGHT)};
+    }
+
+    int mismatches = 0;
+    EntityStore serial;
+    EntityStore store;
+
+    printf("%8s %8s %10s %10s\n", "enemies", "workers", "ms/frame", "speedup");
+    for (int count : counts)
+    {
+        double serialMs = 0.0;
+        for (int workers : workerCounts)
+        {
+            startJobSystem(workers);
+            EntityStore &target = workers == 0 ? serial : store;
+            fillStore(target, count);
+            double ms = runFrames(target, tokens);
+            stopJobSystem();
+
+            if (workers == 0)
+            {
+                serialMs = ms;
+            }
+            else
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    if (store.fx[i] != serial.fx[i] || store.fy[i] != serial.fy[i] || store.hv[i] != serial.hv[i] || store.vv[i] != serial.vv[i])
+                    {
+                        mismatches++;
+                    }
+                }
+            }
+            printf("%8d %8d %10.3f %9.1fx\n", count, workers, ms, serialMs / ms);
+        }
+    }
+
+    if (mismatches > 0)
+    {
+        printf("FAILED: %d enemies ended up somewhere else than on one thread\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Per-frame cost of the game-mode modifier checks in the enemy loop: the
+// string lookups the game used to do for every enemy against the compile-time
+// flags that replaced them (see gameModeModifiers in src/main.cpp).
+//
+//   make -f Makefile.host bench
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+const int FRAMES = 2000;
+const float TICK = 1.0f / 60.0f;
+
+struct Enemy {
+    float fx, fy, hv, vv;
+};
+
+// Before: every check builds a std::string and searches the mode's list
+static const std::vector<std::vector<std::string>> modeStrings = {
+    {},
+    {"noEnemy"},
+    {"spawnEnemyOnMove"},
+    {"angryCelery", "blackEndScreen", "altUI", "enemiesBounce", "randomSizeEnemies", "noCircle"}
+};
+
+static bool contains(const std::vector<std::string> &vec, const std::string &value)
+{
+    return std::find(vec.begin(), vec.end(), value) != vec.end();
+}
+
+static void updateWithStrings(std::vector<Enemy> &enemies, size_t mode)
+{
+    for (auto &enemy : enemies)
+    {
+        if (!contains(modeStrings[mode], "noCircle"))
+        {
+            enemy.hv += 0.001f; // stands in for the orbit step
+        }
+        enemy.fx += enemy.hv * TICK;
+        enemy.fy += enemy.vv * TICK;
+        if (contains(modeStrings[mode], "enemiesBounce") && (enemy.fx < 0.0f || enemy.fx > 1920.0f))
+        {
+            enemy.hv = -enemy.hv;
+        }
+    }
+}
+
+// After: the same loop instantiated per mode, disabled checks fold away
+enum : unsigned {
+    NO_ENEMY = 1u << 0,
+    SPAWN_ENEMY_ON_MOVE = 1u << 1,
+    ANGRY_CELERY = 1u << 2,
+    BLACK_END_SCREEN = 1u << 3,
+    ALT_UI = 1u << 4,
+    ENEMIES_BOUNCE = 1u << 5,
+    RANDOM_SIZE_ENEMIES = 1u << 6,
+    NO_CIRCLE = 1u << 7
+};
+
+template <unsigned Modifiers>
+static void updateWithFlags(std::vector<Enemy> &enemies)
+{
+    for (auto &enemy : enemies)
+    {
+        if (!(Modifiers & NO_CIRCLE))
+        {
+            enemy.hv += 0.001f;
+        }
+        enemy.fx += enemy.hv * TICK;
+        enemy.fy += enemy.vv * TICK;
+        if ((Modifiers & ENEMIES_BOUNCE) && (enemy.fx < 0.0f || enemy.fx > 1920.0f))
+        {
+            enemy.hv = -enemy.hv;
+        }
+    }
+}
+
+static void (*const updateForMode[])(std::vector<Enemy> &) = {
+    updateWithFlags<0>,
+    updateWithFlags<NO_ENEMY>,
+    updateWithFlags<SPAWN_ENEMY_ON_MOVE>,
+    updateWithFlags<ANGRY_CELERY | BLACK_END_SCREEN | ALT_UI | ENEMIES_BOUNCE | RANDOM_SIZE_ENEMIES | NO_CIRCLE>
+};
+
+static std::vector<Enemy> makeEnemies(int count)
+{
+    std::vector<Enemy> enemies(count);
+    for (int i = 0; i < count; i++)
+    {
+        enemies[i] = {static_cast<float>(i % 1920), static_cast<float>(i % 1080), 120.0f + i % 120, 120.0f + i % 90};
+    }
+    return enemies;
+}
+
+static double microsecondsPerFrame(Uint64 start)
+{
+    return (SDL_GetPerformanceCounter() - start) * 1000000.0 / SDL_GetPerformanceFrequency() / FRAMES;
+}
+
+int main()
+{
+    const int counts[] = {200, 1000, 10000};
+    const size_t modes[] = {0, 3};
+    float checksum = 0.0f;
+
+    printf("%8s %5s %16s %16s %10s\n", "enemies", "mode", "strings us/frame", "flags us/frame", "speedup");
+    for (int count : counts)
+    {
+        for (size_t mode : modes)
+        {
+            std::vector<Enemy> enemies = makeEnemies(count);
+            Uint64 start = SDL_GetPerformanceCounter();
+            for (int frame = 0; frame < FRAMES; frame++)
+            {
+                updateWithStrings(enemies, mode);
+            }
+            double strings = microsecondsPerFrame(start);
+            checksum += enemies[0].fx;
+
+            enemies = makeEnemies(count);
+            start = SDL_GetPerformanceCounter();
+            for (int frame = 0; frame < FRAMES; frame++)
+            {
+                updateForMode[mode](enemies);
+            }
+            double flags = microsecondsPerFrame(start);
+            checksum += enemies[0].fx;
+
+            printf("%8d %5zu %16.2f %16.2f %9.1fx\n", count, mode, strings, flags, strings / flags);
+        }
+    }
+    printf("(checksum %.1f)\n", checksum);
+    return 0;
+}
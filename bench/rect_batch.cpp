@@ -0,0 +1,68 @@
+// The mouth-vs-entity test as the game used to do it, one SDL_HasIntersection
+// call per entity, against intersectRectBatch() over the EntityStore columns.
+// Fails if the two find a different number of hits.
+//
+//   make -f Makefile.host bench
+
+#include "../src/rect_batch.h"
+#include "../src/sdl_starter.h"
+#include <stdio.h>
+#include <vector>
+
+const int PASSES = 1000;
+
+int main()
+{
+    const int counts[] = {200, 2000, 20000};
+    int mismatches = 0;
+
+    printf("%8s %14s %14s %10s\n", "rects", "SDL us/pass", "batch us/pass", "speedup");
+    for (int count : counts)
+    {
+        std::vector<int> x(count), y(count), w(count), h(count);
+        for (int i = 0; i < count; i++)
+        {
+            x[i] = (i * 37) % SCREEN_WIDTH;
+            y[i] = (i * 53) % SCREEN_HEIGHT;
+            w[i] = 30 + i % 40;
+            h[i] = 30 + i % 30;
+        }
+        std::vector<Uint32> hits(rectBatchWords(count));
+
+        // Sweep the mouth across the screen so the hit count changes every pass
+        int sdlHits = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            SDL_Rect mouth = {(pass * 13) % SCREEN_WIDTH, (pass * 7) % SCREEN_HEIGHT, 60, 40};
+            for (int i = 0; i < count; i++)
+            {
+                SDL_Rect other = {x[i], y[i], w[i], h[i]};
+                sdlHits += SDL_HasIntersection(&mouth, &other);
+            }
+        }
+        double sdl = (SDL_GetPerformanceCounter() - start) * 1000000.0 / SDL_GetPerformanceFrequency() / PASSES;
+
+        int batchHits = 0;
+        start = SDL_GetPerformanceCounter();
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            SDL_Rect mouth = {(pass * 13) % SCREEN_WIDTH, (pass * 7) % SCREEN_HEIGHT, 60, 40};
+            batchHits += intersectRectBatch(mouth, x.data(), y.data(), w.data(), h.data(), count, hits.data());
+        }
+        double batch = (SDL_GetPerformanceCounter() - start) * 1000000.0 / SDL_GetPerformanceFrequency() / PASSES;
+
+        if (sdlHits != batchHits)
+        {
+            mismatches++;
+        }
+        printf("%8d %14.2f %14.2f %9.1fx\n", count, sdl, batch, sdl / batch);
+    }
+
+    if (mismatches > 0)
+    {
+        printf("FAILED: the batch found a different number of hits than SDL_HasIntersection\n");
+        return 1;
+    }
+    return 0;
+}
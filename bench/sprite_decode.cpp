@@ -0,0 +1,150 @@
+// Sprite load times through the PNG path against the pre-decoded .rgba files
+// from "make -f Makefile.host sprites": read + decode + premultiply + upload,
+// and the texture memory each ends up with. Uploads go to a software renderer,
+// so no window or GPU is needed.
+//
+//   make -f Makefile.host bench
+//
+// Without .rgba files only the PNG column is filled in.
+
+#include "../src/asset_archive.h"
+#include "../src/raw_sprite.h"
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+const int LOADS = 20;
+
+// The PNG half of loadSpritePixels(), which always prefers the .rgba
+static SDL_Texture *loadPng(SDL_Renderer *renderer, const char *path, size_t &bytes)
+{
+    SDL_Surface *loaded = IMG_Load_RW(openAsset(path), 1);
+    if (loaded == nullptr)
+    {
+        return nullptr;
+    }
+    SDL_Surface *surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (surface == nullptr)
+    {
+        return nullptr;
+    }
+    SDL_PremultiplyAlpha(surface->w, surface->h, SDL_PIXELFORMAT_RGBA32, surface->pixels, surface->pitch,
+                         SDL_PIXELFORMAT_RGBA32, surface->pixels, surface->pitch);
+    SDL_Texture *texture = createSpriteTexture(renderer, surface);
+    bytes = static_cast<size_t>(surface->w) * surface->h * 4;
+    SDL_FreeSurface(surface);
+    return texture;
+}
+
+static SDL_Texture *loadRaw(SDL_Renderer *renderer, const char *path, size_t &bytes)
+{
+    SpritePixels pixels;
+    if (!loadSpritePixels(path, pixels) || !pixels.preDecoded)
+    {
+        SDL_FreeSurface(pixels.surface);
+        return nullptr;
+    }
+    SDL_Texture *texture = createSpriteTexture(renderer, pixels.surface);
+    bytes = static_cast<size_t>(pixels.surface->w) * pixels.surface->h * 4;
+    SDL_FreeSurface(pixels.surface);
+    return texture;
+}
+
+typedef SDL_Texture *(*LoadFunction)(SDL_Renderer *renderer, const char *path, size_t &bytes);
+
+// Average ms per load, 0 when it fails
+static double timeLoads(LoadFunction load, SDL_Renderer *renderer, const char *path, size_t &bytes)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < LOADS; i++)
+    {
+        SDL_Texture *texture = load(renderer, path, bytes);
+        if (texture == nullptr)
+        {
+            return 0.0;
+        }
+        SDL_DestroyTexture(texture);
+    }
+    return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / LOADS;
+}
+
+int main(int argc, char **argv)
+{
+    const char *romfs = argc > 1 ? argv[1] : "romfs"; // relative to the repository root
+    if (chdir(romfs) != 0)
+    {
+        printf("FAILED: can't open asset directory %s\n", romfs);
+        return 1;
+    }
+    IMG_Init(IMG_INIT_PNG);
+    SDL_Surface *target = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer *renderer = target != nullptr ? SDL_CreateSoftwareRenderer(target) : nullptr;
+    if (renderer == nullptr)
+    {
+        printf("FAILED: no software renderer: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    std::vector<std::string> paths;
+    listAssets("sprites", paths);
+    double pngTotal = 0.0;
+    double rawTotal = 0.0;
+    size_t pngBytesTotal = 0;
+    size_t rawBytesTotal = 0;
+    int failures = 0;
+    bool anyRaw = false;
+
+    printf("%-32s %10s %10s %10s %10s\n", "sprite", "PNG ms", "KB", "rgba ms", "KB");
+    for (const std::string &path : paths)
+    {
+        if (path.size() < 4 || strcmp(path.c_str() + path.size() - 4, ".png") != 0)
+        {
+            continue;
+        }
+        size_t pngBytes = 0;
+        double png = timeLoads(loadPng, renderer, path.c_str(), pngBytes);
+        if (png == 0.0)
+        {
+            printf("FAILED: %s didn't load\n", path.c_str());
+            failures++;
+            continue;
+        }
+        pngTotal += png;
+        pngBytesTotal += pngBytes;
+
+        if (!assetExists(rawSpritePath(path).c_str()))
+        {
+            printf("%-32s %10.3f %10u %10s %10s\n", path.c_str(), png, static_cast<unsigned>(pngBytes / 1024), "-", "-");
+            rawTotal += png;
+            rawBytesTotal += pngBytes;
+            continue;
+        }
+        size_t rawBytes = 0;
+        double raw = timeLoads(loadRaw, renderer, path.c_str(), rawBytes);
+        if (raw == 0.0)
+        {
+            printf("FAILED: %s didn't load\n", rawSpritePath(path).c_str());
+            failures++;
+            continue;
+        }
+        anyRaw = true;
+        rawTotal += raw;
+        rawBytesTotal += rawBytes;
+        printf("%-32s %10.3f %10u %10.3f %10u\n", path.c_str(), png, static_cast<unsigned>(pngBytes / 1024), raw, static_cast<unsigned>(rawBytes / 1024));
+    }
+
+    printf("%-32s %10.3f %10u %10.3f %10u\n", "all", pngTotal, static_cast<unsigned>(pngBytesTotal / 1024), rawTotal, static_cast<unsigned>(rawBytesTotal / 1024));
+    if (!anyRaw)
+    {
+        printf("No pre-decoded sprites, run \"make -f Makefile.host sprites\" to compare against them\n");
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+    IMG_Quit();
+    return failures > 0 ? 1 : 0;
+}
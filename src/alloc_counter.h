@@ -0,0 +1,15 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// Counts every call to the global operator new, on every thread. Read it
+// before and after code that is meant to be allocation-free and compare.
+// Only built with -DNCES_COUNT_ALLOCATIONS (the host build sets it), other
+// builds keep the library's operator new and always read 0.
+#ifdef NCES_COUNT_ALLOCATIONS
+const bool ALLOCATION_COUNTING = true;
+#else
+const bool ALLOCATION_COUNTING = false;
+#endif
+
+Uint64 allocationCount();
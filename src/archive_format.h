@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+// On-disk layout of assets.pak, shared by the game and tools/pack_assets.cpp.
+// All integers are little endian.
+//
+//   ArchiveHeader
+//   ArchiveEntry[entryCount], sorted by path (strcmp order)
+//   entry paths, NUL terminated, relative to the romfs root ("sprites/celery.png")
+//   file data, every blob starting on an ARCHIVE_ALIGNMENT boundary
+
+const char ARCHIVE_MAGIC[4] = {'N', 'C', 'P', 'K'};
+const uint32_t ARCHIVE_VERSION = 1;
+const uint32_t ARCHIVE_ALIGNMENT = 64;
+const char ARCHIVE_NAME[] = "assets.pak";
+
+struct ArchiveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct ArchiveEntry {
+    uint32_t pathOffset;    // from the start of the archive
+    uint32_t dataOffset;
+    uint32_t size;
+    uint32_t reserved;
+};
@@ -0,0 +1,172 @@
+#include "asset_archive.h"
+#include "archive_format.h"
+#include "platform.h"
+#include "profiler.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+static const Uint8 *archiveData = nullptr;
+static size_t archiveSize = 0;
+static const ArchiveEntry *entries = nullptr;
+static Uint32 entryCount = 0;
+
+static Uint32 entryValue(Uint32 value)
+{
+    return SDL_SwapLE32(value);
+}
+
+static const char *entryPath(const ArchiveEntry &entry)
+{
+    return reinterpret_cast<const char *>(archiveData + entryValue(entry.pathOffset));
+}
+
+bool openAssetArchive(const char *path)
+{
+    closeAssetArchive();
+
+    PROFILE_ZONE("openAssetArchive");
+    size_t size = 0;
+    const void *data = platformMapFile(path, size);
+    if (data == nullptr)
+    {
+        return false;
+    }
+
+    const Uint8 *bytes = static_cast<const Uint8 *>(data);
+    const ArchiveHeader *header = reinterpret_cast<const ArchiveHeader *>(bytes);
+    if (size < sizeof(ArchiveHeader) || memcmp(header->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 || entryValue(header->version) != ARCHIVE_VERSION)
+    {
+        printf("Asset archive %s is not a version %u archive, using loose files\n", path, static_cast<unsigned>(ARCHIVE_VERSION));
+        platformUnmapFile(data, size);
+        return false;
+    }
+
+    Uint32 count = entryValue(header->entryCount);
+    const ArchiveEntry *table = reinterpret_cast<const ArchiveEntry *>(bytes + sizeof(ArchiveHeader));
+    if (count > (size - sizeof(ArchiveHeader)) / sizeof(ArchiveEntry))
+    {
+        printf("Asset archive %s is truncated, using loose files\n", path);
+        platformUnmapFile(data, size);
+        return false;
+    }
+    for (Uint32 i = 0; i < count; i++)
+    {
+        Uint32 pathOffset = entryValue(table[i].pathOffset);
+        Uint32 dataOffset = entryValue(table[i].dataOffset);
+        Uint32 dataSize = entryValue(table[i].size);
+        if (pathOffset >= size || memchr(bytes + pathOffset, '\0', size - pathOffset) == nullptr || dataOffset > size || dataSize > size - dataOffset)
+        {
+            printf("Asset archive %s has a bad entry, using loose files\n", path);
+            platformUnmapFile(data, size);
+            return false;
+        }
+    }
+
+    archiveData = bytes;
+    archiveSize = size;
+    entries = table;
+    entryCount = count;
+    printf("Asset archive: %u files, %u KB\n", static_cast<unsigned>(count), static_cast<unsigned>(size / 1024));
+    return true;
+}
+
+void closeAssetArchive()
+{
+    if (archiveData != nullptr)
+    {
+        platformUnmapFile(archiveData, archiveSize);
+    }
+    archiveData = nullptr;
+    archiveSize = 0;
+    entries = nullptr;
+    entryCount = 0;
+}
+
+bool assetArchiveOpen()
+{
+    return archiveData != nullptr;
+}
+
+static const ArchiveEntry *findEntry(const char *path)
+{
+    const ArchiveEntry *end = entries + entryCount;
+    const ArchiveEntry *found = std::lower_bound(entries, end, path, [](const ArchiveEntry &entry, const char *key) {
+        return strcmp(entryPath(entry), key) < 0;
+    });
+    if (found != end && strcmp(entryPath(*found), path) == 0)
+    {
+        return found;
+    }
+    return nullptr;
+}
+
+SDL_RWops *openAsset(const char *path)
+{
+    if (archiveData != nullptr)
+    {
+        if (const ArchiveEntry *entry = findEntry(path))
+        {
+            return SDL_RWFromConstMem(archiveData + entryValue(entry->dataOffset), static_cast<int>(entryValue(entry->size)));
+        }
+    }
+
+    SDL_RWops *file = SDL_RWFromFile(path, "rb");
+    if (file == nullptr)
+    {
+        printf("Asset %s not found: %s\n", path, SDL_GetError());
+    }
+    return file;
+}
+
+bool assetExists(const char *path)
+{
+    if (archiveData != nullptr && findEntry(path) != nullptr)
+    {
+        return true;
+    }
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISREG(info.st_mode);
+}
+
+void listAssets(const char *directory, std::vector<std::string> &paths)
+{
+    paths.clear();
+    std::string prefix = std::string(directory) + "/";
+
+    if (archiveData != nullptr)
+    {
+        // Sorted table, so the directory is one contiguous run
+        const ArchiveEntry *end = entries + entryCount;
+        const ArchiveEntry *entry = std::lower_bound(entries, end, prefix.c_str(), [](const ArchiveEntry &item, const char *key) {
+            return strcmp(entryPath(item), key) < 0;
+        });
+        for (; entry != end && strncmp(entryPath(*entry), prefix.c_str(), prefix.size()) == 0; entry++)
+        {
+            const char *path = entryPath(*entry);
+            if (strchr(path + prefix.size(), '/') == nullptr)
+            {
+                paths.push_back(path);
+            }
+        }
+        return;
+    }
+
+    DIR *dir = opendir(directory);
+    if (dir == nullptr)
+    {
+        printf("Unable to open asset directory %s\n", directory);
+        return;
+    }
+    while (dirent *entry = readdir(dir))
+    {
+        if (entry->d_name[0] != '.')
+        {
+            paths.push_back(prefix + entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(paths.begin(), paths.end());
+}
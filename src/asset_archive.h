@@ -0,0 +1,27 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+// Read-only view of assets.pak. Once an archive is open every asset is served
+// as an SDL_RWops over memory that stays valid until closeAssetArchive(), no
+// copies and no file handles. Anything not in the archive, or every asset when
+// no archive is open, still comes from the loose files.
+
+// The archive is mapped on the host and read in one go on Wii U. False when
+// it is missing or not a valid archive, loose files are used then.
+bool openAssetArchive(const char *path);
+
+void closeAssetArchive();
+
+bool assetArchiveOpen();
+
+// Path relative to the asset root. Caller frees the RWops, usually by passing
+// freesrc = 1 to the SDL loader. nullptr when the asset does not exist.
+SDL_RWops *openAsset(const char *path);
+
+bool assetExists(const char *path);
+
+// Paths of the files directly inside directory, sorted
+void listAssets(const char *directory, std::vector<std::string> &paths);
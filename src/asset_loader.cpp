@@ -0,0 +1,102 @@
+#include "asset_loader.h"
+#include "asset_archive.h"
+#include "profiler.h"
+#include "sdl_starter.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+
+static std::vector<AssetLoad> loads;
+static std::unique_ptr<std::atomic<bool>[]> loadReady;
+static std::vector<std::thread> loaderThreads;
+static std::atomic<int> nextLoad(0);
+static std::atomic<int> finishedLoads(0);
+static std::atomic<bool> loaderStopping(false);
+
+static void decodeAsset(AssetLoad &load)
+{
+    switch (load.kind)
+    {
+    case ASSET_SPRITE_ATLAS:
+    {
+        PROFILE_ZONE("loadSpriteAtlas");
+        load.failed = !prepareSpriteAtlas(load.path, load.atlasMaxWidth, load.atlasMaxHeight, load.atlas);
+        break;
+    }
+    case ASSET_FONT:
+    {
+        PROFILE_ZONE("loadFont");
+        load.font = TTF_OpenFontRW(openAsset(load.path), 1, load.fontSize);
+        if (load.font == nullptr)
+        {
+            printf("Failed to load font %s! SDL_ttf Error: %s\n", load.path, TTF_GetError());
+        }
+        load.failed = load.font == nullptr;
+        break;
+    }
+    case ASSET_SOUND:
+        load.sound = loadSound(load.path);
+        load.failed = load.sound == nullptr;
+        break;
+    case ASSET_MUSIC:
+        load.music = loadMusic(load.path);
+        load.failed = load.music == nullptr;
+        break;
+    }
+}
+
+static void loaderThread()
+{
+    int count = static_cast<int>(loads.size());
+    for (int i = nextLoad.fetch_add(1); i < count && !loaderStopping.load(std::memory_order_relaxed); i = nextLoad.fetch_add(1))
+    {
+        decodeAsset(loads[i]);
+        loadReady[i].store(true, std::memory_order_release);
+        finishedLoads.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+int queueAssetLoad(const AssetLoad &load)
+{
+    loads.push_back(load);
+    return static_cast<int>(loads.size()) - 1;
+}
+
+void startAssetLoader(int threadCount)
+{
+    loadReady.reset(new std::atomic<bool>[loads.size()]());
+    nextLoad.store(0);
+    finishedLoads.store(0);
+    loaderStopping.store(false);
+    for (int i = 0; i < SDL_max(1, threadCount); i++)
+    {
+        loaderThreads.emplace_back(loaderThread);
+    }
+}
+
+AssetLoad *finishedAssetLoad(int id)
+{
+    if (id < 0 || id >= static_cast<int>(loads.size()) || !loadReady[id].load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    return &loads[id];
+}
+
+void assetLoadProgress(int &finished, int &total)
+{
+    finished = finishedLoads.load(std::memory_order_relaxed);
+    total = static_cast<int>(loads.size());
+}
+
+void stopAssetLoader()
+{
+    loaderStopping.store(true);
+    for (auto &thread : loaderThreads)
+    {
+        thread.join();
+    }
+    loaderThreads.clear();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <SDL2/SDL_ttf.h>
+#include "sprite_atlas.h"
+
+// Boot assets decoded in the background. Loads are queued up front, loader
+// threads decode them (PNG, TTF, audio) in queue order, and the render thread
+// picks each one up once it is done and does whatever needs the renderer.
+
+enum AssetKind {
+    ASSET_SPRITE_ATLAS, // path is the sprite directory
+    ASSET_FONT,
+    ASSET_SOUND,
+    ASSET_MUSIC
+};
+
+struct AssetLoad {
+    AssetKind kind = ASSET_SOUND;
+    const char *path = nullptr;
+    int fontSize = 0;
+    int atlasMaxWidth = 0;      // from spriteAtlasLimits(), the renderer is not touched off-thread
+    int atlasMaxHeight = 0;
+
+    // Filled in by the loader, owned by whoever takes it afterwards
+    PreparedSpriteAtlas atlas;
+    TTF_Font *font = nullptr;
+    Mix_Chunk *sound = nullptr;
+    Mix_Music *music = nullptr;
+    bool failed = false;
+};
+
+// Queue before startAssetLoader(), returns the load's id
+int queueAssetLoad(const AssetLoad &load);
+
+void startAssetLoader(int threadCount);
+
+// The finished load, or nullptr while it is still decoding
+AssetLoad *finishedAssetLoad(int id);
+
+// Loads decoded so far out of all queued
+void assetLoadProgress(int &finished, int &total);
+
+// Waits for the loader threads, loads still queued are skipped
+void stopAssetLoader();
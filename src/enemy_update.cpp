@@ -0,0 +1,142 @@
+#include "enemy_update.h"
+#include "job_system.h"
+#include "profiler.h"
+#include "steering.h"
+#include <cmath>
+
+// Orbiting enemies move 0.04 rad around their token each tick
+static const float ORBIT_STEP = 0.04f;
+static const float ORBIT_STEP_COS = std::cos(ORBIT_STEP);
+static const float ORBIT_STEP_SIN = std::sin(ORBIT_STEP);
+static const float ORBIT_RADIUS = 190.0f;
+static const float ORBIT_RANGE = 200.0f; // protecting enemies start circling this close to their token
+
+void reserveEnemyScratch(EnemyScratch &scratch, int enemyCount, int candidatesPerChunk)
+{
+    size_t chunks = (enemyCount + ENEMY_JOB_CHUNK - 1) / ENEMY_JOB_CHUNK;
+    while (scratch.size() < chunks)
+    {
+        scratch.emplace_back();
+        scratch.back().reserve(candidatesPerChunk);
+    }
+}
+
+void reserveBounceCandidates(EnemyScratch &scratch, int enemyCount, const SpatialGrid &grid)
+{
+    // A crowded grid can hand back more than the usual reserve, an enemy can span four cells
+    size_t capacity = 4 * static_cast<size_t>(spatialGridMaxCellItems(grid));
+    size_t chunks = (enemyCount + ENEMY_JOB_CHUNK - 1) / ENEMY_JOB_CHUNK;
+    for (size_t chunk = 0; chunk < chunks && chunk < scratch.size(); chunk++)
+    {
+        scratch[chunk].reserve(capacity);
+    }
+}
+
+static float distance(const EntityStore &objects1, int object1, const EntityStore &objects2, int object2)
+{
+    float dx = objects1.fx[object1] - objects2.fx[object2];
+    float dy = objects1.fy[object1] - objects2.fy[object2];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+template <bool Hunter, bool AngryCelery>
+void updateEnemies(const EnemyPass &pass)
+{
+    EntityStore &enemies = *pass.enemies;
+    const EntityStore &tokens = *pass.tokens;
+    const float deltaTime = pass.deltaTime;
+
+    parallelFor(enemies.count, ENEMY_JOB_CHUNK, [&](int begin, int end) {
+        PROFILE_ZONE("enemies");
+        // Protecting enemies start circling their token once close. Further out
+        // the game always steered the token, which never moves, so they keep going.
+        for (int i = begin; i < end; i++)
+        {
+            enemies.steering[i] = STEER_NONE;
+            if (pass.orbitTokenForEnemy != nullptr)
+            {
+                int tokenIToCircle = pass.orbitTokenForEnemy[i];
+                if (protectorBehavior(distance(enemies, i, tokens, tokenIToCircle), ORBIT_RANGE) == STEER_ORBIT)
+                {
+                    enemies.steering[i] = STEER_ORBIT;
+                }
+            }
+            // Hunters head down the flow field towards the closest player
+            if (Hunter && enemies.steering[i] == STEER_NONE)
+            {
+                float dirX, dirY;
+                float centerX = enemies.fx[i] + enemies.w[i] / 2.0f;
+                float centerY = enemies.fy[i] + enemies.h[i] / 2.0f;
+                if (sampleFlowField(*pass.hunterField, centerX, centerY, dirX, dirY))
+                {
+                    enemies.steering[i] = STEER_FOLLOW;
+                    followDirection(dirX, dirY, enemies.hv[i], enemies.vv[i]);
+                }
+            }
+        }
+
+        integrateEntities(enemies, deltaTime, begin, end);
+
+        if (pass.orbitTokenForEnemy != nullptr)
+        {
+            // Circle around the token, replaces the integrated position
+            orbitEntities(enemies, tokens, pass.orbitTokenForEnemy, ORBIT_RADIUS, ORBIT_STEP_COS, ORBIT_STEP_SIN, begin, end);
+        }
+
+        // Rects are only rewritten in the second pass, after every bounce test
+        if (pass.bounceGrid != nullptr)
+        {
+            std::vector<int> &candidates = (*pass.scratch)[begin / ENEMY_JOB_CHUNK];
+            for (int i = begin; i < end; i++)
+            {
+                SDL_Rect enemyBounds = entityBounds(enemies, i);
+                querySpatialGridShared(*pass.bounceGrid, enemyBounds, candidates);
+                for (int ii : candidates)
+                {
+                    SDL_Rect otherBounds = entityBounds(enemies, ii);
+                    if (i != ii && SDL_HasIntersection(&enemyBounds, &otherBounds))
+                    {
+                        enemies.hv[i] = -enemies.hv[i];
+                        enemies.vv[i] = -enemies.vv[i];
+                        enemies.fx[i] += enemies.hv[i] * deltaTime * 3;
+                        enemies.fy[i] += enemies.vv[i] * deltaTime * 3;
+                    }
+                }
+            }
+        }
+
+        if (AngryCelery)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                if (enemies.evilTimer[i] > 0)
+                {
+                    --enemies.evilTimer[i];
+                    if (enemies.evilTimer[i] == 899)
+                    {
+                        setEntityState(enemies, i, SPRITE_STATE_ANGRY);
+                        enemies.hv[i] *= 3;
+                        enemies.vv[i] *= 3;
+                    }
+                    else if (enemies.evilTimer[i] == 1)
+                    {
+                        setEntityState(enemies, i, SPRITE_STATE_NORMAL);
+                        enemies.hv[i] /= 3;
+                        enemies.vv[i] /= 3;
+                    }
+                }
+            }
+        }
+    });
+
+    // Bounce off the edges and update the rects for rendering
+    parallelFor(enemies.count, ENEMY_JOB_CHUNK, [&](int begin, int end) {
+        PROFILE_ZONE("constrainEnemies");
+        constrainEntities(enemies, SCREEN_WIDTH, SCREEN_HEIGHT, begin, end);
+    });
+}
+
+template void updateEnemies<false, false>(const EnemyPass &pass);
+template void updateEnemies<false, true>(const EnemyPass &pass);
+template void updateEnemies<true, false>(const EnemyPass &pass);
+template void updateEnemies<true, true>(const EnemyPass &pass);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "entity_store.h"
+#include "flow_field.h"
+#include "spatial_grid.h"
+#include <vector>
+
+// The per-tick enemy pass: steering, movement, orbits around protected
+// tokens, enemy-vs-enemy bounces, angry timers and the bounce off the
+// playfield edges. It runs on the job system in chunks of ENEMY_JOB_CHUNK
+// enemies. A chunk only writes its own enemies and reads the tokens and the
+// other enemies' rects from the last tick, so the result doesn't depend on the
+// worker count. Once the scratch is reserved the pass never allocates.
+
+const int ENEMY_JOB_CHUNK = 256; // smaller lists are updated on the calling thread
+
+// Grid query results, one list per chunk
+typedef std::vector<std::vector<int>> EnemyScratch;
+
+// Grow the scratch to cover enemyCount enemies, a no-op once it has
+void reserveEnemyScratch(EnemyScratch &scratch, int enemyCount, int candidatesPerChunk);
+
+// Make room for whatever a query on grid can return, before a bouncing pass
+void reserveBounceCandidates(EnemyScratch &scratch, int enemyCount, const SpatialGrid &grid);
+
+struct EnemyPass {
+    EntityStore *enemies = nullptr;
+    const EntityStore *tokens = nullptr;
+    const int *orbitTokenForEnemy = nullptr; // token each enemy protects, nullptr when not protecting
+    const FlowField *hunterField = nullptr;  // read with Hunter
+    const SpatialGrid *bounceGrid = nullptr; // last tick's enemy rects, nullptr when enemies don't bounce off each other
+    EnemyScratch *scratch = nullptr;
+    float deltaTime = 0.0f;
+};
+
+// Hunter: enemies not orbiting follow hunterField.
+// AngryCelery: run the angry timers and their speed changes.
+template <bool Hunter, bool AngryCelery>
+void updateEnemies(const EnemyPass &pass);
@@ -0,0 +1,274 @@
+#include "entity_store.h"
+#include "texture_cache.h"
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ENTITY_KERNEL_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ENTITY_KERNEL_NEON
+#endif
+
+// The Wii U build uses the scalar loops, devkitPPC's GCC has no paired-single
+// intrinsics to build a vector path on.
+
+void reserveEntities(EntityStore &store, int capacity)
+{
+    size_t size = static_cast<size_t>(capacity);
+    store.fx.reserve(size);
+    store.fy.reserve(size);
+    store.hv.reserve(size);
+    store.vv.reserve(size);
+    store.x.reserve(size);
+    store.y.reserve(size);
+    store.w.reserve(size);
+    store.h.reserve(size);
+    store.prevFx.reserve(size);
+    store.prevFy.reserve(size);
+    store.image.reserve(size);
+    store.state.reserve(size);
+    store.variants.reserve(size);
+    store.orbitCos.reserve(size);
+    store.orbitSin.reserve(size);
+    store.steering.reserve(size);
+    store.evilTimer.reserve(size);
+}
+
+int addEntity(EntityStore &store, const Sprite &sprite)
+{
+    store.fx.push_back(sprite.fx);
+    store.fy.push_back(sprite.fy);
+    store.hv.push_back(sprite.hv);
+    store.vv.push_back(sprite.vv);
+    store.x.push_back(sprite.bounds.x);
+    store.y.push_back(sprite.bounds.y);
+    store.w.push_back(sprite.bounds.w);
+    store.h.push_back(sprite.bounds.h);
+    store.prevFx.push_back(sprite.fx);
+    store.prevFy.push_back(sprite.fy);
+
+    store.image.push_back(sprite.image);
+    store.state.push_back(sprite.state);
+    std::array<const SpriteImage *, SPRITE_STATE_COUNT> variants;
+    for (int i = 0; i < SPRITE_STATE_COUNT; i++)
+    {
+        variants[i] = sprite.variants[i];
+    }
+    store.variants.push_back(variants);
+    store.orbitCos.push_back(std::cos(sprite.angle));
+    store.orbitSin.push_back(std::sin(sprite.angle));
+    store.steering.push_back(STEER_NONE);
+    store.evilTimer.push_back(sprite.evilTimer);
+
+    return store.count++;
+}
+
+void clearEntities(EntityStore &store)
+{
+    for (auto &variants : store.variants)
+    {
+        for (auto *variant : variants)
+        {
+            releaseImage(variant);
+        }
+    }
+
+    store.fx.clear();
+    store.fy.clear();
+    store.hv.clear();
+    store.vv.clear();
+    store.x.clear();
+    store.y.clear();
+    store.w.clear();
+    store.h.clear();
+    store.prevFx.clear();
+    store.prevFy.clear();
+    store.image.clear();
+    store.state.clear();
+    store.variants.clear();
+    store.orbitCos.clear();
+    store.orbitSin.clear();
+    store.steering.clear();
+    store.evilTimer.clear();
+    store.count = 0;
+}
+
+void setEntityState(EntityStore &store, int index, SpriteState state)
+{
+    const SpriteImage *variant = store.variants[index][state];
+    store.state[index] = state;
+    store.image[index] = variant != nullptr ? variant : store.variants[index][SPRITE_STATE_NORMAL];
+}
+
+void storePreviousPositions(EntityStore &store)
+{
+    store.prevFx.assign(store.fx.begin(), store.fx.end());
+    store.prevFy.assign(store.fy.begin(), store.fy.end());
+}
+
+void integrateEntities(EntityStore &store, float deltaTime, int begin, int end)
+{
+    float *fx = store.fx.data();
+    float *fy = store.fy.data();
+    const float *hv = store.hv.data();
+    const float *vv = store.vv.data();
+    int count = end < 0 ? store.count : end;
+    int i = begin;
+
+#if defined(ENTITY_KERNEL_SSE)
+    __m128 dt = _mm_set1_ps(deltaTime);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(fx + i, _mm_add_ps(_mm_loadu_ps(fx + i), _mm_mul_ps(_mm_loadu_ps(hv + i), dt)));
+        _mm_storeu_ps(fy + i, _mm_add_ps(_mm_loadu_ps(fy + i), _mm_mul_ps(_mm_loadu_ps(vv + i), dt)));
+    }
+#elif defined(ENTITY_KERNEL_NEON)
+    float32x4_t dt = vdupq_n_f32(deltaTime);
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(fx + i, vmlaq_f32(vld1q_f32(fx + i), vld1q_f32(hv + i), dt));
+        vst1q_f32(fy + i, vmlaq_f32(vld1q_f32(fy + i), vld1q_f32(vv + i), dt));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        fx[i] += hv[i] * deltaTime;
+        fy[i] += vv[i] * deltaTime;
+    }
+}
+
+void orbitEntities(EntityStore &store, const EntityStore &centers, const int *centerIndex, float radius, float stepCos, float stepSin, int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        if (store.steering[i] != STEER_ORBIT)
+        {
+            continue;
+        }
+
+        float c = store.orbitCos[i];
+        float s = store.orbitSin[i];
+        if (std::isnan(c))
+        {
+            c = 1.0f; // first orbit starts at angle 0
+            s = 0.0f;
+        }
+
+        int center = centerIndex[i];
+        store.fx[i] = centers.fx[center] + c * radius;
+        store.fy[i] = centers.fy[center] + s * radius;
+
+        // Rotate by one step, then pull back onto the unit circle so rounding doesn't build up
+        float rotatedCos = c * stepCos - s * stepSin;
+        float rotatedSin = s * stepCos + c * stepSin;
+        float scale = 1.5f - 0.5f * (rotatedCos * rotatedCos + rotatedSin * rotatedSin);
+        store.orbitCos[i] = rotatedCos * scale;
+        store.orbitSin[i] = rotatedSin * scale;
+    }
+}
+
+void constrainEntities(EntityStore &store, int width, int height, int begin, int end)
+{
+    float *fx = store.fx.data();
+    float *fy = store.fy.data();
+    float *hv = store.hv.data();
+    float *vv = store.vv.data();
+    int *x = store.x.data();
+    int *y = store.y.data();
+    const int *w = store.w.data();
+    const int *h = store.h.data();
+    int count = end < 0 ? store.count : end;
+    int i = begin;
+
+#if defined(ENTITY_KERNEL_SSE)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128i screenW = _mm_set1_epi32(width);
+    const __m128i screenH = _mm_set1_epi32(height);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(fx + i);
+        __m128 py = _mm_loadu_ps(fy + i);
+        __m128 maxX = _mm_cvtepi32_ps(_mm_sub_epi32(screenW, _mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i))));
+        __m128 maxY = _mm_cvtepi32_ps(_mm_sub_epi32(screenH, _mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i))));
+
+        // Lanes that left the playfield get clamped and their velocity sign flipped.
+        // Same order as the scalar loop: below 0 wins, so an entity wider than
+        // the screen (maxX < 0) ends up in the same place on every build.
+        __m128 belowX = _mm_cmplt_ps(px, zero);
+        __m128 belowY = _mm_cmplt_ps(py, zero);
+        __m128 outX = _mm_or_ps(belowX, _mm_cmpgt_ps(px, maxX));
+        __m128 outY = _mm_or_ps(belowY, _mm_cmpgt_ps(py, maxY));
+        px = _mm_andnot_ps(belowX, _mm_min_ps(px, maxX));
+        py = _mm_andnot_ps(belowY, _mm_min_ps(py, maxY));
+
+        _mm_storeu_ps(fx + i, px);
+        _mm_storeu_ps(fy + i, py);
+        _mm_storeu_ps(hv + i, _mm_xor_ps(_mm_loadu_ps(hv + i), _mm_and_ps(outX, signBit)));
+        _mm_storeu_ps(vv + i, _mm_xor_ps(_mm_loadu_ps(vv + i), _mm_and_ps(outY, signBit)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(x + i), _mm_cvttps_epi32(px));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(y + i), _mm_cvttps_epi32(py));
+    }
+#elif defined(ENTITY_KERNEL_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const uint32x4_t signBit = vdupq_n_u32(0x80000000u);
+    const int32x4_t screenW = vdupq_n_s32(width);
+    const int32x4_t screenH = vdupq_n_s32(height);
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t px = vld1q_f32(fx + i);
+        float32x4_t py = vld1q_f32(fy + i);
+        float32x4_t maxX = vcvtq_f32_s32(vsubq_s32(screenW, vld1q_s32(w + i)));
+        float32x4_t maxY = vcvtq_f32_s32(vsubq_s32(screenH, vld1q_s32(h + i)));
+
+        uint32x4_t belowX = vcltq_f32(px, zero);
+        uint32x4_t belowY = vcltq_f32(py, zero);
+        uint32x4_t outX = vorrq_u32(belowX, vcgtq_f32(px, maxX));
+        uint32x4_t outY = vorrq_u32(belowY, vcgtq_f32(py, maxY));
+        px = vbslq_f32(belowX, zero, vminq_f32(px, maxX));
+        py = vbslq_f32(belowY, zero, vminq_f32(py, maxY));
+
+        vst1q_f32(fx + i, px);
+        vst1q_f32(fy + i, py);
+        vst1q_f32(hv + i, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vld1q_f32(hv + i)), vandq_u32(outX, signBit))));
+        vst1q_f32(vv + i, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vld1q_f32(vv + i)), vandq_u32(outY, signBit))));
+        vst1q_s32(x + i, vcvtq_s32_f32(px));
+        vst1q_s32(y + i, vcvtq_s32_f32(py));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        float maxX = static_cast<float>(width - w[i]);
+        float maxY = static_cast<float>(height - h[i]);
+
+        // Bounce off left/right edges
+        if (fx[i] < 0)
+        {
+            fx[i] = 0;
+            hv[i] = -hv[i];
+        }
+        else if (fx[i] > maxX)
+        {
+            fx[i] = maxX;
+            hv[i] = -hv[i];
+        }
+
+        // Bounce off top/bottom edges
+        if (fy[i] < 0)
+        {
+            fy[i] = 0;
+            vv[i] = -vv[i];
+        }
+        else if (fy[i] > maxY)
+        {
+            fy[i] = maxY;
+            vv[i] = -vv[i];
+        }
+
+        x[i] = static_cast<int>(fx[i]);
+        y[i] = static_cast<int>(fy[i]);
+    }
+}
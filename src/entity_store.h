@@ -0,0 +1,73 @@
+#pragma once
+
+#include "sdl_starter.h"
+#include "steering.h"
+#include <array>
+#include <vector>
+
+// Structure-of-arrays storage for enemies and tokens.
+// The fields the per-tick kernels touch (positions, velocities, rects) are
+// packed into their own arrays; images, timers and flags are kept apart so
+// the hot loops never pull them into cache.
+//
+// Entities stay packed at [0, count) so the kernels never skip holes.
+
+struct EntityStore {
+    int count = 0;
+
+    // Hot, walked by integrateEntities()/constrainEntities() every tick
+    std::vector<float> fx;
+    std::vector<float> fy;
+    std::vector<float> hv;
+    std::vector<float> vv;
+    std::vector<int> x;     // render/collision rect, synced from fx/fy
+    std::vector<int> y;
+    std::vector<int> w;
+    std::vector<int> h;
+    std::vector<float> prevFx; // position at the previous tick, for render interpolation
+    std::vector<float> prevFy;
+
+    // Cold
+    std::vector<const SpriteImage *> image;
+    std::vector<SpriteState> state;
+    std::vector<std::array<const SpriteImage *, SPRITE_STATE_COUNT>> variants;
+    std::vector<float> orbitCos;    // orbit angle as a unit vector, NaN until the first orbit
+    std::vector<float> orbitSin;
+    std::vector<SteeringBehavior> steering;
+    std::vector<int> evilTimer;
+};
+
+// Grow every column to capacity up front so spawning up to it never allocates.
+// Clearing keeps the capacity, a restarted round reuses the same memory.
+void reserveEntities(EntityStore &store, int capacity);
+
+// Append a loaded sprite, the store takes over its image references
+int addEntity(EntityStore &store, const Sprite &sprite);
+
+// Release every entity's images and empty the store
+void clearEntities(EntityStore &store);
+
+// Switch to a preloaded state, same rules as setSpriteState()
+void setEntityState(EntityStore &store, int index, SpriteState state);
+
+inline SDL_Rect entityBounds(const EntityStore &store, int index)
+{
+    return {store.x[index], store.y[index], store.w[index], store.h[index]};
+}
+
+// Remember this tick's positions before the next one moves them
+void storePreviousPositions(EntityStore &store);
+
+// The kernels below cover [begin, end), the whole store by default. Ranges
+// don't overlap in what they write, so job chunks can run them side by side.
+
+// fx += hv * dt, fy += vv * dt for every entity
+void integrateEntities(EntityStore &store, float deltaTime, int begin = 0, int end = -1);
+
+// Place entities steered with STEER_ORBIT on a circle of radius around
+// centers[centerIndex[i]] and advance their angle by one step. The angle is
+// rotated by (stepCos, stepSin) instead of calling cos/sin every tick.
+void orbitEntities(EntityStore &store, const EntityStore &centers, const int *centerIndex, float radius, float stepCos, float stepSin, int begin, int end);
+
+// Bounce off the playfield edges and sync the int rects from fx/fy
+void constrainEntities(EntityStore &store, int width, int height, int begin = 0, int end = -1);
@@ -0,0 +1,121 @@
+#include "flow_field.h"
+#include <algorithm>
+#include <cmath>
+
+static const int NEIGHBOUR_X[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+static const int NEIGHBOUR_Y[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+void initFlowField(FlowField &field, int width, int height)
+{
+    field.columns = (width + FLOW_CELL_SIZE - 1) / FLOW_CELL_SIZE;
+    field.rows = (height + FLOW_CELL_SIZE - 1) / FLOW_CELL_SIZE;
+    size_t cells = static_cast<size_t>(field.columns) * field.rows;
+    field.distance.assign(cells, FLOW_UNREACHED);
+    field.directionX.assign(cells, 0.0f);
+    field.directionY.assign(cells, 0.0f);
+    field.frontier.clear();
+    field.frontier.reserve(cells);
+}
+
+static int cellAt(const FlowField &field, float x, float y)
+{
+    int column = SDL_max(0, SDL_min(field.columns - 1, static_cast<int>(x) / FLOW_CELL_SIZE));
+    int row = SDL_max(0, SDL_min(field.rows - 1, static_cast<int>(y) / FLOW_CELL_SIZE));
+    return row * field.columns + column;
+}
+
+static void setDirection(FlowField &field, int cell, float x, float y)
+{
+    float length = std::sqrt(x * x + y * y);
+    if (length > 0.0f)
+    {
+        field.directionX[cell] = x / length;
+        field.directionY[cell] = y / length;
+    }
+    else
+    {
+        field.directionX[cell] = 0.0f;
+        field.directionY[cell] = 0.0f;
+    }
+}
+
+void buildFlowField(FlowField &field, const float *targetX, const float *targetY, int targetCount)
+{
+    std::fill(field.distance.begin(), field.distance.end(), FLOW_UNREACHED);
+    std::fill(field.directionX.begin(), field.directionX.end(), 0.0f);
+    std::fill(field.directionY.begin(), field.directionY.end(), 0.0f);
+    field.frontier.clear();
+
+    for (int i = 0; i < targetCount; i++)
+    {
+        int cell = cellAt(field, targetX[i], targetY[i]);
+        if (field.distance[cell] != 0)
+        {
+            field.distance[cell] = 0;
+            field.frontier.push_back(cell);
+        }
+
+        // Aim straight at the target from its own cell, first target wins
+        if (field.directionX[cell] == 0.0f && field.directionY[cell] == 0.0f)
+        {
+            float centerX = (cell % field.columns + 0.5f) * FLOW_CELL_SIZE;
+            float centerY = (cell / field.columns + 0.5f) * FLOW_CELL_SIZE;
+            setDirection(field, cell, targetX[i] - centerX, targetY[i] - centerY);
+        }
+    }
+
+    // Multi-source BFS, every step (diagonals included) costs one
+    for (size_t head = 0; head < field.frontier.size(); head++)
+    {
+        int cell = field.frontier[head];
+        int x = cell % field.columns;
+        int y = cell / field.columns;
+        Uint16 next = field.distance[cell] + 1;
+        for (int n = 0; n < 8; n++)
+        {
+            int nx = x + NEIGHBOUR_X[n];
+            int ny = y + NEIGHBOUR_Y[n];
+            if (nx < 0 || ny < 0 || nx >= field.columns || ny >= field.rows)
+            {
+                continue;
+            }
+            int neighbour = ny * field.columns + nx;
+            if (field.distance[neighbour] == FLOW_UNREACHED)
+            {
+                field.distance[neighbour] = next;
+                field.frontier.push_back(neighbour);
+            }
+        }
+    }
+
+    // Point every other reached cell at its closest neighbour. Averaging the
+    // neighbours that are one step closer keeps diagonals from zig-zagging.
+    for (int cell = 0; cell < static_cast<int>(field.distance.size()); cell++)
+    {
+        Uint16 here = field.distance[cell];
+        if (here == 0 || here == FLOW_UNREACHED)
+        {
+            continue;
+        }
+
+        int x = cell % field.columns;
+        int y = cell / field.columns;
+        float sumX = 0.0f;
+        float sumY = 0.0f;
+        for (int n = 0; n < 8; n++)
+        {
+            int nx = x + NEIGHBOUR_X[n];
+            int ny = y + NEIGHBOUR_Y[n];
+            if (nx < 0 || ny < 0 || nx >= field.columns || ny >= field.rows)
+            {
+                continue;
+            }
+            if (field.distance[ny * field.columns + nx] < here)
+            {
+                sumX += NEIGHBOUR_X[n];
+                sumY += NEIGHBOUR_Y[n];
+            }
+        }
+        setDirection(field, cell, sumX, sumY);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+// Coarse distance field over the playfield, seeded from any number of target
+// points and rebuilt once per tick. Each cell stores a unit direction towards
+// the nearest target, so steering any number of entities is one lookup each.
+
+const int FLOW_CELL_SIZE = 60; // 32x18 cells on 1920x1080
+const Uint16 FLOW_UNREACHED = 0xFFFF;
+
+struct FlowField {
+    int columns = 0;
+    int rows = 0;
+    std::vector<Uint16> distance;   // steps to the nearest target, FLOW_UNREACHED without targets
+    std::vector<float> directionX;  // unit vector to follow, 0,0 where there is nowhere to go
+    std::vector<float> directionY;
+    std::vector<int> frontier;      // BFS queue, kept between builds
+};
+
+void initFlowField(FlowField &field, int width, int height);
+
+// Breadth-first fill from the cells holding the targets, then point every cell
+// at its closest neighbour. Targets in the same cell as a point are aimed at directly.
+void buildFlowField(FlowField &field, const float *targetX, const float *targetY, int targetCount);
+
+// Direction at a playfield position, false where the field has none
+inline bool sampleFlowField(const FlowField &field, float x, float y, float &directionX, float &directionY)
+{
+    int column = SDL_max(0, SDL_min(field.columns - 1, static_cast<int>(x) / FLOW_CELL_SIZE));
+    int row = SDL_max(0, SDL_min(field.rows - 1, static_cast<int>(y) / FLOW_CELL_SIZE));
+    int cell = row * field.columns + column;
+    directionX = field.directionX[cell];
+    directionY = field.directionY[cell];
+    return directionX != 0.0f || directionY != 0.0f;
+}
@@ -0,0 +1,83 @@
+#include "frame_budget.h"
+#include <atomic>
+#include <stdio.h>
+
+const double BUDGET_HIGH = 0.9 * FRAME_BUDGET;  // over this counts as overloaded
+const double BUDGET_LOW = 0.6 * FRAME_BUDGET;   // under this counts as headroom
+const double BUDGET_SMOOTHING = 0.1;            // weight of the newest sample
+const int TICKS_TO_DEGRADE = 15;                // a quarter second over budget sheds a level
+const int TICKS_TO_RECOVER = 120;               // two seconds of headroom gives one back
+
+static std::atomic<float> renderSeconds(0.0f);
+static double averageUpdate = 0.0;
+static double averageRender = 0.0;
+static int overloadedTicks = 0;
+static int headroomTicks = 0;
+static std::atomic<int> currentLevel(BUDGET_FULL);
+
+static const char *LEVEL_NAMES[BUDGET_LEVEL_COUNT] = {"full", "no spawn", "no bounce", "no orbit"};
+
+void reportRenderTime(double seconds)
+{
+    renderSeconds.store(static_cast<float>(seconds), std::memory_order_relaxed);
+}
+
+BudgetLevel updateFrameBudget(double updateSeconds)
+{
+    // Smooth both so a single hitch does not shed work
+    averageUpdate += (updateSeconds - averageUpdate) * BUDGET_SMOOTHING;
+    averageRender += (renderSeconds.load(std::memory_order_relaxed) - averageRender) * BUDGET_SMOOTHING;
+    double cost = SDL_max(averageUpdate, averageRender);
+
+    int current = currentLevel.load(std::memory_order_relaxed);
+    int next = current;
+    if (cost > BUDGET_HIGH)
+    {
+        headroomTicks = 0;
+        if (++overloadedTicks >= TICKS_TO_DEGRADE && current < BUDGET_LEVEL_COUNT - 1)
+        {
+            next = current + 1;
+            overloadedTicks = 0;
+        }
+    }
+    else if (cost < BUDGET_LOW)
+    {
+        overloadedTicks = 0;
+        if (++headroomTicks >= TICKS_TO_RECOVER && current > BUDGET_FULL)
+        {
+            next = current - 1;
+            headroomTicks = 0;
+        }
+    }
+    else
+    {
+        overloadedTicks = 0;
+        headroomTicks = 0;
+    }
+
+    if (next != current)
+    {
+        printf("Frame budget: %s (update %.2f ms, render %.2f ms)\n", LEVEL_NAMES[next], averageUpdate * 1000.0, averageRender * 1000.0);
+        currentLevel.store(next, std::memory_order_relaxed);
+    }
+    return static_cast<BudgetLevel>(next);
+}
+
+BudgetLevel frameBudgetLevel()
+{
+    return static_cast<BudgetLevel>(currentLevel.load(std::memory_order_relaxed));
+}
+
+void resetFrameBudget()
+{
+    averageUpdate = 0.0;
+    averageRender = 0.0;
+    overloadedTicks = 0;
+    headroomTicks = 0;
+    currentLevel.store(BUDGET_FULL, std::memory_order_relaxed);
+}
+
+const char *budgetLevelName(BudgetLevel level)
+{
+    return LEVEL_NAMES[level];
+}
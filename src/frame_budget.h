@@ -0,0 +1,32 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// Adaptive quality for scenes too heavy for 60 fps. The simulation and render
+// threads report how long their work took; while either runs over budget the
+// governor steps down one level at a time, first holding the enemy count and
+// then shedding optional work, and steps back up once there is headroom.
+
+enum BudgetLevel : int {
+    BUDGET_FULL,        // everything on
+    BUDGET_NO_SPAWN,    // stop spawning, hold the enemy count
+    BUDGET_NO_BOUNCE,   // skip enemy-enemy bounce checks
+    BUDGET_NO_ORBIT,    // protecting enemies stop circling their tokens
+    BUDGET_LEVEL_COUNT
+};
+
+// Seconds per frame the update and the render each have to fit in
+const double FRAME_BUDGET = 1.0 / 60.0;
+
+// Render thread, time spent building the frame (not waiting on vsync)
+void reportRenderTime(double seconds);
+
+// Simulation thread, once per tick with that tick's update time. Returns the level to run the next tick at.
+BudgetLevel updateFrameBudget(double updateSeconds);
+
+BudgetLevel frameBudgetLevel();
+
+// Back to full quality, e.g. on restart
+void resetFrameBudget();
+
+const char *budgetLevelName(BudgetLevel level);
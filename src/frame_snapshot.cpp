@@ -0,0 +1,29 @@
+#include "frame_snapshot.h"
+#include <atomic>
+
+static const Uint8 SNAPSHOT_FRESH = 0x4; // set on the shared index when it holds an unread snapshot
+static const Uint8 SNAPSHOT_INDEX = 0x3;
+
+static FrameSnapshot snapshots[3];
+static Uint8 writeIndex = 0;
+static Uint8 readIndex = 1;
+static std::atomic<Uint8> sharedIndex(2);
+
+FrameSnapshot &snapshotForWriting()
+{
+    return snapshots[writeIndex];
+}
+
+void publishSnapshot()
+{
+    writeIndex = sharedIndex.exchange(writeIndex | SNAPSHOT_FRESH, std::memory_order_acq_rel) & SNAPSHOT_INDEX;
+}
+
+const FrameSnapshot &latestSnapshot()
+{
+    if (sharedIndex.load(std::memory_order_acquire) & SNAPSHOT_FRESH)
+    {
+        readIndex = sharedIndex.exchange(readIndex, std::memory_order_acq_rel) & SNAPSHOT_INDEX;
+    }
+    return snapshots[readIndex];
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+struct SpriteImage;
+
+// Everything render() needs from one simulation tick. The simulation thread
+// fills one in after every tick and publishes it; the render thread draws the
+// newest published one without ever touching live game state.
+
+struct SnapshotSprite {
+    const SpriteImage *image;
+    float prevX, prevY;     // position at the tick before, for interpolation
+    float x, y;
+    int w, h;
+};
+
+struct SnapshotLabel {
+    int number;
+    int x, y;
+};
+
+struct FrameSnapshot {
+    Uint64 tick = 0;
+    Uint64 publishedAt = 0; // performance counter when the tick finished
+    int screen = 0;         // GameScreen the tick ended on, the menu until the first one
+    int gameMode = 0;
+    int enemyEaten = 0;
+    int tokensEaten = 0;
+    int enemyCount = 0;
+    int budgetLevel = 0;    // BudgetLevel the tick ran at
+    std::vector<SnapshotSprite> sprites;   // draw order: players, enemies, tokens
+    std::vector<SnapshotLabel> labels;     // player numbers, drawn above the sprites
+};
+
+// Triple buffered: the writer always has a buffer of its own, the reader keeps
+// the one it is drawing, and the third holds the newest finished snapshot.
+// Publishing and picking up are a single atomic exchange, neither side waits.
+
+// Writer side, the buffer to fill for the next publishSnapshot()
+FrameSnapshot &snapshotForWriting();
+
+void publishSnapshot();
+
+// Reader side, the newest published snapshot. Stays valid until the next call.
+const FrameSnapshot &latestSnapshot();
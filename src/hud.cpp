@@ -0,0 +1,77 @@
+#include "hud.h"
+#include "text_atlas.h"
+#include "profiler.h"
+#include <string.h>
+
+static Uint32 rebuilds = 0;
+
+void setWidgetText(TextWidget &widget, const char *text)
+{
+    if (widget.text != text)
+    {
+        widget.text.assign(text);
+        widget.dirty = true;
+    }
+}
+
+void setWidgetText(TextWidget &widget, const std::string &text)
+{
+    if (widget.text != text)
+    {
+        widget.text = text;
+        widget.dirty = true;
+    }
+}
+
+void setWidgetLayout(TextWidget &widget, int x, int y, TextAlign align)
+{
+    if (widget.x != x || widget.y != y || widget.align != align)
+    {
+        widget.x = x;
+        widget.y = y;
+        widget.align = align;
+        widget.dirty = true;
+    }
+}
+
+void setWidgetColor(TextWidget &widget, SDL_Color color)
+{
+    if (memcmp(&widget.color, &color, sizeof(color)) != 0)
+    {
+        widget.color = color;
+        widget.dirty = true;
+    }
+}
+
+Uint32 hudRebuildCount()
+{
+    return rebuilds;
+}
+
+void drawWidget(SDL_Renderer *renderer, TextWidget &widget)
+{
+    if (!widget.visible || !glyphAtlasReady())
+    {
+        return;
+    }
+
+    if (widget.dirty)
+    {
+        PROFILE_ZONE("rebuildWidget");
+        int width = 0;
+        measureAtlasText(widget.text.c_str(), &width, nullptr);
+        int x = widget.x;
+        if (widget.align == TEXT_ALIGN_CENTER)
+        {
+            x -= width / 2;
+        }
+        else if (widget.align == TEXT_ALIGN_RIGHT)
+        {
+            x -= width;
+        }
+        buildAtlasTextGeometry(widget.text.c_str(), x, widget.y, widget.color, widget.vertices, widget.indices);
+        widget.dirty = false;
+        rebuilds++;
+    }
+    drawAtlasGeometry(renderer, widget.vertices, widget.indices);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+// Retained text for the HUD and menus. A widget keeps its glyph quads between
+// frames and only rebuilds them when its text, position or colour actually
+// changes, so an unchanged HUD costs one SDL_RenderGeometry per widget and no
+// string building or allocation.
+
+enum TextAlign {
+    TEXT_ALIGN_LEFT,
+    TEXT_ALIGN_CENTER,  // x is the middle of the text
+    TEXT_ALIGN_RIGHT    // x is where the text ends
+};
+
+struct TextWidget {
+    std::string text;
+    int x = 0;
+    int y = 0;
+    TextAlign align = TEXT_ALIGN_LEFT;
+    SDL_Color color = {0, 0, 0, 255};
+    bool visible = true;
+
+    bool dirty = true;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+// Each setter marks the widget dirty only when the value differs
+void setWidgetText(TextWidget &widget, const char *text);
+
+void setWidgetText(TextWidget &widget, const std::string &text);
+
+void setWidgetLayout(TextWidget &widget, int x, int y, TextAlign align);
+
+void setWidgetColor(TextWidget &widget, SDL_Color color);
+
+// Rebuilds the geometry if needed and draws it. Widgets stay dirty until the
+// glyph atlas exists, so text set while the font is still loading shows up.
+void drawWidget(SDL_Renderer *renderer, TextWidget &widget);
+
+// Geometry rebuilds since boot, should stay flat while nothing on screen changes
+Uint32 hudRebuildCount();
@@ -0,0 +1,78 @@
+#include "input.h"
+#include <mutex>
+
+InputFrame currentInput;
+
+static std::mutex liveInputMutex;
+static InputFrame liveInput;
+
+// Only the buttons the game reads are recorded
+static const SDL_GameControllerButton recordedButtons[] = {
+    SDL_CONTROLLER_BUTTON_A,
+    SDL_CONTROLLER_BUTTON_DPAD_UP,
+    SDL_CONTROLLER_BUTTON_DPAD_DOWN,
+    SDL_CONTROLLER_BUTTON_DPAD_LEFT,
+    SDL_CONTROLLER_BUTTON_DPAD_RIGHT
+};
+
+void captureInput(InputFrame &frame, SDL_GameController *const controllers[INPUT_SLOTS], Uint8 commands)
+{
+    for (int slot = 0; slot < INPUT_SLOTS; slot++)
+    {
+        SDL_GameController *controller = controllers[slot];
+        InputSlot &input = frame.slots[slot];
+        input = InputSlot();
+
+        if (controller == nullptr)
+        {
+            continue;
+        }
+
+        input.attached = SDL_GameControllerGetAttached(controller) ? 1 : 0;
+        input.playerIndex = static_cast<Sint8>(SDL_GameControllerGetPlayerIndex(controller));
+        input.leftX = SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_LEFTX);
+        input.leftY = SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_LEFTY);
+        for (auto button : recordedButtons)
+        {
+            if (SDL_GameControllerGetButton(controller, button))
+            {
+                input.buttons |= 1u << button;
+            }
+        }
+    }
+    frame.commands = commands;
+}
+
+bool sameInput(const InputFrame &a, const InputFrame &b)
+{
+    if (a.commands != b.commands)
+    {
+        return false;
+    }
+    for (int slot = 0; slot < INPUT_SLOTS; slot++)
+    {
+        const InputSlot &slotA = a.slots[slot];
+        const InputSlot &slotB = b.slots[slot];
+        if (slotA.buttons != slotB.buttons || slotA.leftX != slotB.leftX || slotA.leftY != slotB.leftY ||
+            slotA.playerIndex != slotB.playerIndex || slotA.attached != slotB.attached)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void publishLiveInput(const InputFrame &frame)
+{
+    std::lock_guard<std::mutex> lock(liveInputMutex);
+    Uint8 commands = liveInput.commands | frame.commands;
+    liveInput = frame;
+    liveInput.commands = commands;
+}
+
+void takeLiveInput(InputFrame &frame)
+{
+    std::lock_guard<std::mutex> lock(liveInputMutex);
+    frame = liveInput;
+    liveInput.commands = 0;
+}
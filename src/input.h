@@ -0,0 +1,61 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// Per-tick controller snapshot. The simulation only reads input through
+// this, so a tick can be fed from live controllers or from a replay log.
+
+const int INPUT_SLOTS = 5; // Gamepad + 4 Pro Controllers
+
+// Button presses that arrive as events instead of being polled
+enum InputCommand : Uint8 {
+    INPUT_COMMAND_MENU = 1 << 0,  // - : back to game select
+    INPUT_COMMAND_PAUSE = 1 << 1  // + : toggle pause
+};
+
+struct InputSlot {
+    Uint16 buttons = 0;     // bit per SDL_GameControllerButton
+    Sint16 leftX = 0;
+    Sint16 leftY = 0;
+    Sint8 playerIndex = -1;
+    Uint8 attached = 0;
+};
+
+struct InputFrame {
+    InputSlot slots[INPUT_SLOTS];
+    Uint8 commands = 0;
+};
+
+// Input the current tick runs with
+extern InputFrame currentInput;
+
+void captureInput(InputFrame &frame, SDL_GameController *const controllers[INPUT_SLOTS], Uint8 commands);
+
+bool sameInput(const InputFrame &a, const InputFrame &b);
+
+// Hand-off from the thread polling SDL to the simulation thread. The newest
+// controller state wins, commands from every publish are kept until a tick
+// takes them.
+void publishLiveInput(const InputFrame &frame);
+
+void takeLiveInput(InputFrame &frame);
+
+inline bool inputButton(int slot, SDL_GameControllerButton button)
+{
+    return (currentInput.slots[slot].buttons & (1u << button)) != 0;
+}
+
+inline Sint16 inputAxis(int slot, SDL_GameControllerAxis axis)
+{
+    return axis == SDL_CONTROLLER_AXIS_LEFTX ? currentInput.slots[slot].leftX : currentInput.slots[slot].leftY;
+}
+
+inline bool inputAttached(int slot)
+{
+    return currentInput.slots[slot].attached != 0;
+}
+
+inline int inputPlayerIndex(int slot)
+{
+    return currentInput.slots[slot].playerIndex;
+}
@@ -0,0 +1,185 @@
+#include "job_system.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct JobChunk {
+    JobRangeFunction function;
+    void *context;
+    int begin;
+    int end;
+};
+
+// Chunks are handed out before anyone starts working, so a plain vector with
+// a head index is enough: the owner pops the tail, thieves advance the head.
+struct JobQueue {
+    std::mutex mutex;
+    std::vector<JobChunk> chunks;
+    size_t head = 0;
+};
+
+static std::vector<std::thread> workers;
+static std::vector<JobQueue *> queues;     // [0] belongs to the calling thread
+static std::atomic<int> chunksRemaining(0);
+
+static std::mutex wakeMutex;
+static std::condition_variable wakeCondition;
+static unsigned batchId = 0;
+static bool stopping = false;
+
+static bool popOwnChunk(JobQueue &queue, JobChunk &chunk)
+{
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.head == queue.chunks.size())
+    {
+        return false;
+    }
+    chunk = queue.chunks.back();
+    queue.chunks.pop_back();
+    if (queue.head == queue.chunks.size())
+    {
+        queue.chunks.clear();
+        queue.head = 0;
+    }
+    return true;
+}
+
+static bool stealChunk(JobQueue &queue, JobChunk &chunk)
+{
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.head == queue.chunks.size())
+    {
+        return false;
+    }
+    chunk = queue.chunks[queue.head++];
+    if (queue.head == queue.chunks.size())
+    {
+        queue.chunks.clear();
+        queue.head = 0;
+    }
+    return true;
+}
+
+// Run chunks until every queue is empty
+static void drainQueues(size_t own)
+{
+    JobChunk chunk;
+    for (;;)
+    {
+        bool found = popOwnChunk(*queues[own], chunk);
+        for (size_t i = 1; !found && i < queues.size(); i++)
+        {
+            found = stealChunk(*queues[(own + i) % queues.size()], chunk);
+        }
+        if (!found)
+        {
+            return;
+        }
+        chunk.function(chunk.context, chunk.begin, chunk.end);
+        chunksRemaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+static void workerLoop(size_t own)
+{
+    unsigned seenBatch = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait(lock, [&] { return stopping || batchId != seenBatch; });
+            if (stopping)
+            {
+                return;
+            }
+            seenBatch = batchId;
+        }
+        drainQueues(own);
+    }
+}
+
+void startJobSystem(int workerCount)
+{
+    stopJobSystem();
+
+    if (workerCount < 0)
+    {
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = cores > 1 ? cores - 1 : 0;
+    }
+
+    stopping = false;
+    for (int i = 0; i <= workerCount; i++)
+    {
+        queues.push_back(new JobQueue());
+        queues.back()->chunks.reserve(64); // dealing out chunks shouldn't allocate once running
+    }
+    for (int i = 1; i <= workerCount; i++)
+    {
+        workers.emplace_back(workerLoop, static_cast<size_t>(i));
+    }
+}
+
+void stopJobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    for (auto *queue : queues)
+    {
+        delete queue;
+    }
+    queues.clear();
+}
+
+int jobWorkerCount()
+{
+    return static_cast<int>(workers.size());
+}
+
+void runParallelRange(int count, int chunkSize, JobRangeFunction function, void *context)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    if (workers.empty() || count <= chunkSize)
+    {
+        function(context, 0, count);
+        return;
+    }
+
+    // Deal the chunks out round robin, neighbouring chunks land on different threads
+    int chunkCount = (count + chunkSize - 1) / chunkSize;
+    chunksRemaining.store(chunkCount, std::memory_order_release);
+    for (int i = 0; i < chunkCount; i++)
+    {
+        JobQueue &queue = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        int begin = i * chunkSize;
+        queue.chunks.push_back({function, context, begin, begin + chunkSize < count ? begin + chunkSize : count});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        batchId++;
+    }
+    wakeCondition.notify_all();
+
+    drainQueues(0);
+
+    // Others may still be finishing chunks they took
+    while (chunksRemaining.load(std::memory_order_acquire) > 0)
+    {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <type_traits>
+
+// Small fixed pool of worker threads for splitting a loop into chunks.
+// Every thread (the caller included) owns a queue of chunks, takes work from
+// the back of its own and steals from the front of the others' once it runs
+// dry. The caller blocks until the whole range is done, so chunk bodies may
+// read anything but must only write to their own [begin, end).
+
+// workerCount < 0 picks one worker per core besides the calling thread
+void startJobSystem(int workerCount);
+
+void stopJobSystem();
+
+int jobWorkerCount();
+
+typedef void (*JobRangeFunction)(void *context, int begin, int end);
+
+// Runs function over [0, count) in chunks of chunkSize. Ranges that fit in one
+// chunk, or a pool without workers, run inline on the calling thread.
+void runParallelRange(int count, int chunkSize, JobRangeFunction function, void *context);
+
+template <typename Body>
+void parallelFor(int count, int chunkSize, Body &&body)
+{
+    typedef typename std::remove_reference<Body>::type BodyType;
+    runParallelRange(count, chunkSize, [](void *context, int begin, int end) {
+        (*static_cast<BodyType *>(context))(begin, end);
+    }, const_cast<void *>(static_cast<const void *>(&body)));
+}
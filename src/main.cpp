@@ -1,24 +1,48 @@
 #include "sdl_starter.h"      // Custom header file for SDL helper functions
+#include "texture_cache.h"    // Shared sprite textures
+#include "text_atlas.h"       // Pre-rasterized font glyphs
+#include "sprite_atlas.h"     // All sprites packed into atlas pages
+#include "sprite_batch.h"     // Sprites drawn as one vertex buffer per texture
+#include "spatial_grid.h"     // Collision broadphase
+#include "entity_store.h"     // Enemy/token storage
+#include "platform.h"         // Wii U / host process and filesystem setup
+#include "input.h"            // Per-tick controller snapshots
+#include "replay.h"           // Input recording and playback
+#include "random.h"           // Seedable per-subsystem PRNG
+#include "job_system.h"       // Worker threads for the enemy update
+#include "frame_snapshot.h"   // Game state handed from the simulation to the renderer
+#include "profiler.h"         // Scoped timing zones and trace export
+#include "steering.h"         // Seek/orbit/follow behaviours
+#include "enemy_update.h"     // The enemy pass, on the job system
+#include "alloc_counter.h"    // Heap allocation counting
+#include "flow_field.h"       // Shared pathing towards the players
+#include "frame_budget.h"     // Adaptive quality under load
+#include "rect_batch.h"       // One-against-many rect tests
+#include "asset_archive.h"    // Packed assets
+#include "archive_format.h"
+#include "asset_loader.h"     // Boot assets decoded in the background
+#include "hud.h"              // Retained text widgets
 #include <time.h>             // For random number seeding and time functions
-#include <unistd.h>           // For chdir() to change directory
-#include <romfs-wiiu.h>       // Wii U ROM filesystem functions
-#include <whb/proc.h>         // Wii U process handling
 #include <string>             // C++ string support
-#include <stdlib.h> // rand, srand
 #include <vector>
 #include <cmath>
 #include <algorithm>
-#include <whb/file.h>
 #include <sys/stat.h>
+#include <atomic>
+#include <thread>
 
 const std::string gameModeNames[] = {
     "Nic Cage Eats Stuff",
     "EASY Nic Cage Eats Stuff",
     "IMPOSSIBLE Nic Cage Eats Stuff",
-    "Nic Cage Eats Stuff 2"
+    "Nic Cage Eats Stuff 2",
+    "Nic Cage Gets Hunted",
+    "Nic Cage Stress Test"
 };
 
 const std::string tokenToCollectText[] = {
+    "Chicken eaten: ",
+    "Chicken eaten: ",
     "Chicken eaten: ",
     "Chicken eaten: ",
     "Chicken eaten: ",
@@ -26,6 +50,8 @@ const std::string tokenToCollectText[] = {
 };
 
 const std::string enemyToCollectText[] = {
+    "Celery eaten: ",
+    "Celery eaten: ",
     "Celery eaten: ",
     "Celery eaten: ",
     "Celery eaten: ",
@@ -36,17 +62,23 @@ const int maxEnemyEaten[] = {
     3,
     999,
     10,
-    3
+    3,
+    10,
+    999
 };
 
 const std::string gameOverText[] = {
     "You died! Press A to restart or - to change game.",
     "How did you die? Press A to restart or - to change game.",
     "You are trash lol. Press A to restart or - to change game.",
-    "GAME OVER. Press A to restart or - to change game."
+    "GAME OVER. Press A to restart or - to change game.",
+    "The celery got you. Press A to restart or - to change game.",
+    "Too much celery. Press A to restart or - to change game."
 };
 
 const char* playerImage[] = {
+    "sprites/NicCageFace.png",
+    "sprites/NicCageFace.png",
     "sprites/NicCageFace.png",
     "sprites/NicCageFace.png",
     "sprites/NicCageFace.png",
@@ -54,6 +86,8 @@ const char* playerImage[] = {
 };
 
 const char* playerTransparentImage[] = {
+    "sprites/NicCageFaceTransparent.png",
+    "sprites/NicCageFaceTransparent.png",
     "sprites/NicCageFaceTransparent.png",
     "sprites/NicCageFaceTransparent.png",
     "sprites/NicCageFaceTransparent.png",
@@ -61,6 +95,8 @@ const char* playerTransparentImage[] = {
 };
 
 const char* tokenImage[] = {
+    "sprites/chicken.png",
+    "sprites/chicken.png",
     "sprites/chicken.png",
     "sprites/chicken.png",
     "sprites/chicken.png",
@@ -68,30 +104,80 @@ const char* tokenImage[] = {
 };
 
 const char* enemyImage[] = {
+    "sprites/celery.png",
+    "sprites/celery.png",
     "sprites/celery.png",
     "sprites/celery.png",
     "sprites/celery.png",
     "sprites/celery.png"
 };
 
+const char* angryEnemyImage[] = {
+    "sprites/red_celery.png",
+    "sprites/red_celery.png",
+    "sprites/red_celery.png",
+    "sprites/red_celery.png",
+    "sprites/red_celery.png",
+    "sprites/red_celery.png"
+};
+
 const int tokenCount[] = {
     1,
     5,
     1,
+    1,
+    1,
     1
 };
 
-const std::vector<std::vector<std::string>> gameModeModifiers = {
-    {},
-    {"noEnemy"},
-    {"spawnEnemyOnMove"},
-    {"angryCelery", "blackEndScreen", "altUI", "enemiesBounce", "randomSizeEnemies", "noCircle"}
+// Entity stores are preallocated to these so spawning never reallocates
+const int MAX_ENEMIES = 200;
+const int STRESS_MAX_ENEMIES = 20000;
+const int MAX_TOKENS = 5;
+const int STRESS_SPAWN_PER_TICK = 40;
+
+const int maxEnemies[] = {
+    MAX_ENEMIES,
+    MAX_ENEMIES,
+    MAX_ENEMIES,
+    MAX_ENEMIES,
+    MAX_ENEMIES,
+    STRESS_MAX_ENEMIES
 };
 
+// Game mode modifiers, one bit each so checking them is a single AND
+enum GameModeModifier : unsigned {
+    MOD_NONE = 0,
+    MOD_NO_ENEMY = 1u << 0,
+    MOD_SPAWN_ENEMY_ON_MOVE = 1u << 1,
+    MOD_ANGRY_CELERY = 1u << 2,
+    MOD_BLACK_END_SCREEN = 1u << 3,
+    MOD_ALT_UI = 1u << 4,
+    MOD_ENEMIES_BOUNCE = 1u << 5,
+    MOD_RANDOM_SIZE_ENEMIES = 1u << 6,
+    MOD_NO_CIRCLE = 1u << 7,
+    MOD_HUNTER = 1u << 8,    // celery follow a flow field to the nearest player
+    MOD_STRESS = 1u << 9     // keep spawning up to the stress limit, governed by the frame budget
+};
+
+constexpr unsigned gameModeModifiers[] = {
+    MOD_NONE,
+    MOD_NO_ENEMY,
+    MOD_SPAWN_ENEMY_ON_MOVE,
+    MOD_ANGRY_CELERY | MOD_BLACK_END_SCREEN | MOD_ALT_UI | MOD_ENEMIES_BOUNCE | MOD_RANDOM_SIZE_ENEMIES | MOD_NO_CIRCLE,
+    MOD_HUNTER | MOD_NO_CIRCLE,
+    MOD_STRESS | MOD_ENEMIES_BOUNCE
+};
+
+static_assert(sizeof(gameModeModifiers) / sizeof(gameModeModifiers[0]) == sizeof(gameModeNames) / sizeof(gameModeNames[0]), "every game mode needs its modifiers");
+static_assert(sizeof(maxEnemies) / sizeof(maxEnemies[0]) == sizeof(gameModeNames) / sizeof(gameModeNames[0]), "every game mode needs an enemy limit");
+
 const int playerSpeed[] = {
     250,
     500,
     250,
+    250,
+    300,
     250
 };
 
@@ -100,8 +186,8 @@ const int playerSpeed[] = {
 
 
 
-int rng(int min, int max) {
-    return min + rand() % (max - min + 1);
+int rng(int min, int max, RandomStream stream = RNG_SPAWN) {
+    return randomInt(stream, min, max);
 }
 
 // SDL objects
@@ -118,18 +204,22 @@ int PLAYER_SPEED = 250;           // Player movement speed in pixels/sec
 
 // Player sprite
 Sprite playerSprite;                    // Custom struct representing the player
-std::vector<Sprite> players;            // players
-SDL_Rect mouth;                    // Custom struct representing the player's mouth
-std::vector<SDL_Rect> mouths;        // mouths
+std::vector<Sprite> players;            // players, one per controller slot
 
 // Audio
 Mix_Music *music = nullptr;             // Background music
 Mix_Chunk *sound = nullptr;             // Short sound effects
 
 // Game state
-bool isGamePaused = false;              // Flag for pause state
 bool isGameRunning = true;              // Main loop control flag
-std::string currentScreen = "menu";
+Uint8 pendingCommands = 0;              // INPUT_COMMAND_* pressed since the last tick
+bool isReplaying = false;               // Input comes from a replay log instead of the controllers
+bool isRecording = false;               // Input is written to a replay log
+std::atomic<bool> gameAssetsReady(false); // Sprites and sounds are uploaded, set by the render thread
+bool gameInitialized = false;           // Simulation side: the first game objects exist, so a game can start
+BudgetLevel budgetLevel = BUDGET_FULL;  // Optional work the current tick may skip, only lowered in stress mode
+std::atomic<bool> isSimulationRunning(false); // Simulation thread keeps ticking while set
+Uint64 simulationTick = 0;              // Ticks simulated since boot
 size_t currentGameMode = 0; // 0 is classic, 1 is easy, 2 is impossible
 
 
@@ -169,11 +259,18 @@ int ballVelocityY = 400;                // Ball velocity Y (pixels/sec)
 Sprite enemySprite;                    // Custom struct representing the enemy
 int evilEnemyTimer = 1800;
 
-std::vector<Sprite> enemies;
+EntityStore enemies;
 float enemySpeedMin = 120.0f;
 float enemySpeedMax = 240.0f;
 
-std::vector<Sprite> tokens;
+EntityStore tokens;
+
+// Broadphase for enemy-enemy bounces, indices match enemies
+SpatialGrid enemyGrid;
+
+// Mouth collision results, one bit per enemy/token
+std::vector<Uint32> enemyHits;
+std::vector<Uint32> tokenHits;
 
 // Ball color handling
 int colorIndex = 0;                     // Index of current ball color
@@ -265,23 +362,20 @@ void refreshControllers() {
     } else if (SDL_GameControllerGetPlayerIndex(fifthConnectedController) == 4) {
         controller4 = fifthConnectedController;
     }
+}
 
-    for (auto& player : players) {
-        if (player.controllerId == 0) {
-            player.controller = controller;
-        } else if (player.controllerId == 1) {
-            player.controller = controller1;
-        } else if (player.controllerId == 2) {
-            player.controller = controller2;
-        } else if (player.controllerId == 3) {
-            player.controller = controller3;
-        } else if (player.controllerId == 4) {
-            player.controller = controller4;
-        }
+// Dump the captured zones next to the game, chrome://tracing opens the file
+void saveProfileTrace() {
+    if (platformWritablePath()[0] == '\0') {
+        printf("No writable storage, profile trace not saved\n");
+        return;
     }
+    std::string tracePath = std::string(platformWritablePath()) + "/nces-trace.json";
+    writeProfileTrace(tracePath.c_str());
 }
 
 void handleEvents() {
+    PROFILE_ZONE("handleEvents");
     SDL_Event event;
 
     // Poll all events in the queue
@@ -292,14 +386,22 @@ void handleEvents() {
         }
 
         if (event.type == SDL_JOYBUTTONDOWN) { // Controller button pressed
+            // Handled on the next tick so they end up in the input snapshot
             if (event.jbutton.button == BUTTON_MINUS) { // Minus button quits back to game select
-                currentScreen = "menu";
-                isGamePaused = false;
+                pendingCommands |= INPUT_COMMAND_MENU;
             }
 
             if (event.jbutton.button == BUTTON_PLUS) { // Plus button toggles pause
-                isGamePaused = !isGamePaused;
-                Mix_PlayChannel(-1, sound, 0); // Play sound effect
+                pendingCommands |= INPUT_COMMAND_PAUSE;
+            }
+
+            if (event.jbutton.button == BUTTON_STICKR) { // Right stick click starts/stops profiling
+                if (profileCaptureActive()) {
+                    stopProfileCapture();
+                    saveProfileTrace();
+                } else {
+                    startProfileCapture();
+                }
             }
         }
         if (event.type == SDL_CONTROLLERDEVICEADDED) {
@@ -325,18 +427,22 @@ void handleEvents() {
 }
 
 // ------------------ UTILITY ------------------
-int getRandomNumberBetweenRange(int min, int max) {
+int getRandomNumberBetweenRange(int min, int max, RandomStream stream = RNG_SPAWN) {
     // Return a random integer between min and max inclusive
-    return min + rand() / (RAND_MAX / (max - min + 1) + 1);
+    return randomInt(stream, min, max);
 }
 
-float rngFloat(float min, float max)
+float rngFloat(float min, float max, RandomStream stream = RNG_SPAWN)
 {
-    return min + static_cast<float>(rand()) / RAND_MAX * (max - min);
+    return randomFloat(stream, min, max);
 }
 
-bool contains(const std::vector<std::string>& vec, const std::string& value) {
-    return std::find(vec.begin(), vec.end(), value) != vec.end();
+bool modeHasModifier(size_t gameMode, unsigned modifier) {
+    return (gameModeModifiers[gameMode] & modifier) != 0;
+}
+
+bool hasModifier(unsigned modifier) {
+    return modeHasModifier(currentGameMode, modifier);
 }
 
 // Function to add an enemy
@@ -344,14 +450,19 @@ void addEnemyCustom(SDL_Renderer* renderer, const char* filePath, int x, int y,
     // Load the sprite with optional speed
     Sprite newEnemy = loadSprite(renderer, filePath, x, y, hv, vv);
 
-    if (contains(gameModeModifiers[currentGameMode], "randomSizeEnemies")) {
-        float enemySizeMultiplier = rngFloat(0.5f, 2.0f);
+    if (hasModifier(MOD_RANDOM_SIZE_ENEMIES)) {
+        float enemySizeMultiplier = rngFloat(0.5f, 2.0f, RNG_SIZE);
         newEnemy.bounds.w *= enemySizeMultiplier;
         newEnemy.bounds.h *= enemySizeMultiplier;
     }
 
-    // Add it to the dynamic vector
-    enemies.push_back(newEnemy);
+    if (hasModifier(MOD_ANGRY_CELERY)) {
+        loadSpriteVariant(renderer, newEnemy, SPRITE_STATE_ANGRY, angryEnemyImage[currentGameMode]);
+    }
+
+    // Add it to the enemy store
+    int enemyI = addEntity(enemies, newEnemy);
+    updateSpatialGridItem(enemyGrid, enemyI, newEnemy.bounds);
 }
 
 // Function to add a token
@@ -359,33 +470,53 @@ void addTokenCustom(SDL_Renderer* renderer, const char* filePath, int x, int y,
     // Load the sprite with optional speed
     Sprite newToken = loadSprite(renderer, filePath, x, y, hv, vv);
 
-    // Add it to the dynamic vector
-    tokens.push_back(newToken);
+    // Add it to the token store
+    addEntity(tokens, newToken);
 }
 
-void addPlayerCustom(SDL_Renderer* renderer, const char* filePath, int x, int y, SDL_GameController* controller = controller, int controllerId = 0) {
+void addPlayerCustom(SDL_Renderer* renderer, const char* filePath, int x, int y, int controllerId = 0) {
     Sprite newPlayer = loadSprite(renderer, filePath, x, y);
-    newPlayer.controller = controller;
     newPlayer.controllerId = controllerId;
+    loadSpriteVariant(renderer, newPlayer, SPRITE_STATE_INVULNERABLE, playerTransparentImage[currentGameMode]);
+
+    // Setup mouth rectangle relative to player's position
+    newPlayer.mouth.x = x + 27;   // Adjust offset as done in your main loop
+    newPlayer.mouth.y = y + 88;
+    newPlayer.mouth.w = 40;
+    newPlayer.mouth.h = 20;
 
     players.push_back(newPlayer);
+}
 
-    // Setup mouth rectangle relative to player's position
-    SDL_Rect mouth;
-    mouth.x = x + 27;   // Adjust offset as done in your main loop
-    mouth.y = y + 88;
-    mouth.w = 40;
-    mouth.h = 20;
+// Scratch space for bulk spawns, kept between calls
+std::vector<int> spawnX, spawnY;
+std::vector<float> spawnHv, spawnVv;
 
-    mouths.push_back(mouth);
+// Function to add several enemies, their random values are drawn in bulk
+void addEnemies(int count) {
+    int enemyLen = enemies.count;
+    count = SDL_min(count, maxEnemies[currentGameMode] - enemyLen);
+    if (hasModifier(MOD_NO_ENEMY) || count <= 0) {
+        return;
+    }
+
+    spawnX.resize(count);
+    spawnY.resize(count);
+    spawnHv.resize(count);
+    spawnVv.resize(count);
+    randomFillInt(RNG_SPAWN, spawnX.data(), count, 0, SCREEN_WIDTH - 30);
+    randomFillInt(RNG_SPAWN, spawnY.data(), count, 0, SCREEN_HEIGHT - 30);
+    randomFillFloat(RNG_SPAWN, spawnHv.data(), count, enemySpeedMin, enemySpeedMax);
+    randomFillFloat(RNG_SPAWN, spawnVv.data(), count, enemySpeedMin, enemySpeedMax);
+
+    for (int i = 0; i < count; i++) {
+        addEnemyCustom(renderer, enemyImage[currentGameMode], spawnX[i], spawnY[i], spawnHv[i], spawnVv[i]);
+    }
 }
 
 // Function to add an enemy
 void addEnemy() {
-    int enemyLen = static_cast<int>(enemies.size());
-    if (!(contains(gameModeModifiers[currentGameMode], "noEnemy")) && enemyLen < 200) {
-        addEnemyCustom(renderer, enemyImage[currentGameMode], rng(0, SCREEN_WIDTH - 30), rng(0, SCREEN_HEIGHT - 30), rngFloat(enemySpeedMin, enemySpeedMax), rngFloat(enemySpeedMin, enemySpeedMax));
-    }
+    addEnemies(1);
 }
 
 // Function to add a token
@@ -393,120 +524,128 @@ void addToken() {
     addTokenCustom(renderer, tokenImage[currentGameMode], rng(0, SCREEN_WIDTH - 30), rng(0, SCREEN_HEIGHT - 30), 0.0f, 0.0f);
 }
 
-void addPlayer(SDL_GameController* controller = controller, int controllerId = 0) {
-    addPlayerCustom(renderer, playerImage[currentGameMode], SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2, controller, controllerId);
+void addPlayer(int controllerId = 0) {
+    addPlayerCustom(renderer, playerImage[currentGameMode], SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2, controllerId);
 }
 
 // Helper funcs
-void circleAroundObject(Sprite& center, Sprite& orbiter, float radius)
-{
-    // If angle was never initialized (0 means allowed, so detect NaN instead)
-    if (std::isnan(orbiter.angle))
-        orbiter.angle = 0.0f;
-
-    // Compute new float position
-    orbiter.fx = center.fx + std::cos(orbiter.angle) * radius;
-    orbiter.fy = center.fy + std::sin(orbiter.angle) * radius;
-
-    // Update angle by +0.2
-    //orbiter.angle += 0.2f;
-
-    // Wrap at 2π
-    //const float TAU = 2.0f * M_PI;
-    //if (orbiter.angle >= TAU)
-        //orbiter.angle -= TAU;
+// Token each enemy protects, only depends on the enemy and token counts
+std::vector<int> orbitTokenForEnemy;
+int orbitEnemyCount = -1;
+int orbitTokenCount = -1;
+
+void updateOrbitAssignments(int enemyLen, int tokenLen) {
+    if (enemyLen == orbitEnemyCount && tokenLen == orbitTokenCount) {
+        return;
+    }
+    orbitEnemyCount = enemyLen;
+    orbitTokenCount = tokenLen;
+    orbitTokenForEnemy.resize(enemyLen);
+    if (tokenLen == 0) {
+        return;
+    }
+    // Consecutive enemies share a token, spread evenly over the tokens
+    for (int i = 0; i < enemyLen; i++) {
+        orbitTokenForEnemy[i] = static_cast<int>(std::floor(static_cast<float>(i) / (static_cast<float>(enemyLen) / static_cast<float>(tokenLen))));
+    }
+}
 
-    orbiter.angle = fmodf(orbiter.angle + 0.04, 2*M_PI);
+// Hunter mode: one field per tick towards every player, sampled by each enemy
+FlowField hunterField;
+float hunterTargetX[INPUT_SLOTS];
+float hunterTargetY[INPUT_SLOTS];
 
-    // Update render position (convert float → int)
-    orbiter.bounds.x = static_cast<int>(orbiter.fx);
-    orbiter.bounds.y = static_cast<int>(orbiter.fy);
+void updateHunterField() {
+    int targets = 0;
+    for (const Sprite& player : players) {
+        if (targets == INPUT_SLOTS) {
+            break;
+        }
+        hunterTargetX[targets] = player.fx + player.bounds.w / 2.0f;
+        hunterTargetY[targets] = player.fy + player.bounds.h / 2.0f;
+        targets++;
+    }
+    buildFlowField(hunterField, hunterTargetX, hunterTargetY, targets);
 }
 
-std::string horizontalDirection(const Sprite& object1, const Sprite& object2)
-{
-    float horizontal = object1.fx - object2.fx;
-
-    if (horizontal > 0)
-        return "right";
-    else if (horizontal < 0)
-        return "left";
-    else
-        return "equal";
+void logTextureStats() {
+    TextureCacheStats textureStats = getTextureCacheStats();
+    SDL_Log("Textures: %d loaded, %u KB, %u uploads since boot", textureStats.textures, static_cast<unsigned>(textureStats.bytes / 1024), static_cast<unsigned>(textureStats.uploads));
 }
 
-std::string verticalDirection(const Sprite& object1, const Sprite& object2)
-{
-    float vertical = object1.fy - object2.fy;
-
-    if (vertical > 0)
-        return "top";
-    //else if (vertical < 0)
-        //return "bottom";
-    else
-        //return "equal";  // optional, for the rare case of exact same y
-        return "bottom";
+void logSpriteBatchStats() {
+    SpriteBatchStats batchStats = getSpriteBatchStats();
+    SDL_Log("Sprite batch: %d sprites in %d draw calls last frame", batchStats.sprites, batchStats.drawCalls);
 }
 
+// Heap allocations (on every thread) and texture uploads between the last two
+// rendered frames. Both should sit at 0 during play once everything is warm.
+Uint64 frameAllocations = 0;
+Uint32 frameTextureUploads = 0;
+Uint64 lastAllocationCount = 0;
+Uint32 lastTextureUploadCount = 0;
+
+void countFrameWork() {
+    Uint64 allocations = allocationCount();
+    Uint32 uploads = textureUploadCount();
+    frameAllocations = allocations - lastAllocationCount;
+    frameTextureUploads = uploads - lastTextureUploadCount;
+    lastAllocationCount = allocations;
+    lastTextureUploadCount = uploads;
+}
 
-void attract(Sprite& object1, Sprite& object2)
-{
-    std::string h = horizontalDirection(object1, object2);
-    std::string v = verticalDirection(object1, object2);
+void logFrameWorkStats() {
+    SDL_Log("Last frame: %llu allocations, %u texture uploads, %u HUD rebuilds since boot", static_cast<unsigned long long>(frameAllocations), static_cast<unsigned>(frameTextureUploads), static_cast<unsigned>(hudRebuildCount()));
+}
 
-    // Reverse horizontal velocity if moving in the wrong direction
-    if ((h == "left"  && object2.hv > 0) ||
-        (h == "right" && object2.hv < 0))
-    {
-        object2.hv = -object2.hv;
-    }
+// Grid query scratch for each chunk of the enemy update
+EnemyScratch enemyJobCandidates;
 
-    // Reverse vertical velocity if moving in the wrong direction
-    if ((v == "top"    && object2.vv < 0) ||
-        (v == "bottom" && object2.vv > 0))
-    {
-        object2.vv = -object2.vv;
-    }
+void reserveEnemyScratch(int enemyLen) {
+    reserveEnemyScratch(enemyJobCandidates, enemyLen, 4 * MAX_ENEMIES); // an enemy can span four cells
 }
 
-float distance(const Sprite& object1, const Sprite& object2) {
-    float dx = object1.fx - object2.fx;
-    float dy = object1.fy - object2.fy;
-    return std::sqrt(dx * dx + dy * dy);
-}
+// Heap allocations made inside the enemy loop during a replay, should stay 0
+Uint64 enemyLoopAllocations = 0;
+
+// Last round's entities, kept until the new round is spawned. Swapping back
+// and forth between these and the live ones reuses both sets of allocations.
+EntityStore retiredEnemies, retiredTokens;
+std::vector<Sprite> retiredPlayers;
 
 void restartGame() {
-    enemies.clear();
-    tokens.clear();
-    players.clear();
-    mouths.clear();
+    // Keep the old sprites alive until the new ones are spawned so the
+    // textures they share stay in the cache instead of being decoded again
+    std::swap(retiredEnemies, enemies);
+    std::swap(retiredTokens, tokens);
+    retiredPlayers.swap(players);
+    Sprite oldPlayerSprite = playerSprite;
+    resetSpatialGrid(enemyGrid);
     evilEnemyTimer = 1800;
+    resetFrameBudget();
+    budgetLevel = BUDGET_FULL;
     addEnemy();
     for (int i = 0; i < tokenCount[currentGameMode]; i++) {
         addToken();
     }
     playerSprite = loadSprite(renderer, playerImage[currentGameMode], SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
     PLAYER_SPEED = playerSpeed[currentGameMode];
-    addPlayer(controller, 0);
-    addPlayer(controller1, 1);
-    addPlayer(controller2, 2);
-    addPlayer(controller3, 3);
-    addPlayer(controller4, 4);
-    for (auto& player : players) {
-        if (player.controllerId == 0) {
-            player.controller = controller;
-        } else if (player.controllerId == 1) {
-            player.controller = controller1;
-        } else if (player.controllerId == 2) {
-            player.controller = controller2;
-        } else if (player.controllerId == 3) {
-            player.controller = controller3;
-        } else if (player.controllerId == 4) {
-            player.controller = controller4;
-        }
+    // Players only see controllers through the input snapshot, one per slot
+    for (int slot = 0; slot < INPUT_SLOTS; slot++) {
+        addPlayer(slot);
     }
     enemyEaten = 0;
     tokenseaten = 0;
+
+    clearEntities(retiredEnemies);
+    clearEntities(retiredTokens);
+    for (auto& player : retiredPlayers) {
+        releaseSprite(player);
+    }
+    retiredPlayers.clear();
+    releaseSprite(oldPlayerSprite);
+
+    logTextureStats();
 }
 
 bool previousInvulnerable = false;
@@ -514,443 +653,866 @@ bool previousLeft = false;
 bool previousRight = false;
 
 // ------------------ GAME LOGIC ------------------
-void update(float deltaTime) {
-    // Move player based on controller input
-    if (currentScreen == "menu") {
-        if (SDL_GameControllerGetPlayerIndex(controller) >= 0 && controller != nullptr && SDL_GameControllerGetAttached(controller)) {
-            if (SDL_GameControllerGetButton(controller, SDL_CONTROLLER_BUTTON_A)) {
-                currentScreen = "game";            
-                isGamePaused = false;
-                restartGame();
-            }
-            if (SDL_GameControllerGetButton(controller, SDL_CONTROLLER_BUTTON_DPAD_LEFT)) {
-                if (currentGameMode > 0 && !previousLeft) {
-                    currentGameMode--;
+// The game loop is instantiated once per game mode so modifier checks are
+// resolved at compile time and disabled modifiers cost nothing per entity
+template <unsigned Modifiers>
+void updateGame(float deltaTime) {
+    int playerI2 = 0;
+    for (auto& playerSprite : players) {
+        PROFILE_ZONE("playerInput");
+        int slot = playerI2; // players are created one per controller slot
+        if (inputPlayerIndex(slot) >= 0 && inputAttached(slot)) {
+            playerSprite.controllerId = inputPlayerIndex(slot);
+        }
+        if (!playerSprite.immobile && enemyEaten < maxEnemyEaten[currentGameMode]) {
+            if (inputButton(slot, SDL_CONTROLLER_BUTTON_DPAD_UP)) {
+                playerSprite.fy -= PLAYER_SPEED * deltaTime;
+                if (playerSprite.fy < -80) { // Wrap around top -> bottom
+                    playerSprite.fy = SCREEN_HEIGHT - playerSprite.bounds.h;
                 }
-                previousLeft = true;
-            } else {
-                previousLeft = false;
-            }
-            if (SDL_GameControllerGetButton(controller, SDL_CONTROLLER_BUTTON_DPAD_RIGHT)) {
-                //int gameModeLength = sizeof(gameModeNames);
-                size_t gameModeLength = sizeof(gameModeNames) / sizeof(gameModeNames[0]);
-                if (currentGameMode < (gameModeLength - 1) && !previousRight) {
-                    currentGameMode++;
+                if (Modifiers & MOD_SPAWN_ENEMY_ON_MOVE) {
+                    addEnemy();
                 }
-                previousRight = true;
-            } else {
-                previousRight = false;
-            }
-        } else {
-            if (SDL_GameControllerGetButton(controller1, SDL_CONTROLLER_BUTTON_A)) {
-                currentScreen = "game";            
-                isGamePaused = false;
-                restartGame();
-            }
-            if (SDL_GameControllerGetButton(controller1, SDL_CONTROLLER_BUTTON_DPAD_LEFT)) {
-                if (currentGameMode > 0 && !previousLeft) {
-                    currentGameMode--;
+            } else if (static_cast<float>(inputAxis(slot, SDL_CONTROLLER_AXIS_LEFTY) / 32768.0f) < -0.1f) {
+                playerSprite.fy += static_cast<float>(inputAxis(slot, SDL_CONTROLLER_AXIS_LEFTY)) / 32768 * PLAYER_SPEED * deltaTime;
+                if (playerSprite.fy < -80) { // Wrap around top -> bottom
+                    playerSprite.fy = SCREEN_HEIGHT - playerSprite.bounds.h;
                 }
-                previousLeft = true;
-            } else {
-                previousLeft = false;
-            }
-            if (SDL_GameControllerGetButton(controller1, SDL_CONTROLLER_BUTTON_DPAD_RIGHT)) {
-                //int gameModeLength = sizeof(gameModeNames);
-                size_t gameModeLength = sizeof(gameModeNames) / sizeof(gameModeNames[0]);
-                if (currentGameMode < (gameModeLength - 1) && !previousRight) {
-                    currentGameMode++;
+                if (Modifiers & MOD_SPAWN_ENEMY_ON_MOVE) {
+                    addEnemy();
                 }
-                previousRight = true;
-            } else {
-                previousRight = false;
             }
-        }
-    }
-    if (currentScreen == "game") {
-        int playerI2 = 0;
-        for (auto& playerSprite : players) {
-            if (SDL_GameControllerGetPlayerIndex(playerSprite.controller) >= 0 && playerSprite.controller != nullptr && SDL_GameControllerGetAttached(playerSprite.controller)) {
-                playerSprite.controllerId = SDL_GameControllerGetPlayerIndex(playerSprite.controller);
+            if (inputButton(slot, SDL_CONTROLLER_BUTTON_DPAD_DOWN)) {
+                playerSprite.fy += PLAYER_SPEED * deltaTime;
+                if (playerSprite.fy > SCREEN_HEIGHT - playerSprite.bounds.h + 80) { // Wrap bottom -> top
+                    playerSprite.fy = 0;
+                }
+                if (Modifiers & MOD_SPAWN_ENEMY_ON_MOVE) {
+                    addEnemy();
+                }
+            } else if (static_cast<float>(inputAxis(slot, SDL_CONTROLLER_AXIS_LEFTY) / 32768.0f) > 0.1f) {
+                playerSprite.fy += static_cast<float>(inputAxis(slot, SDL_CONTROLLER_AXIS_LEFTY)) / 32768 * PLAYER_SPEED * deltaTime;
+                if (playerSprite.fy > SCREEN_HEIGHT - playerSprite.bounds.h + 80) { // Wrap bottom -> top
+                    playerSprite.fy = 0;
+                }
+                if (Modifiers & MOD_SPAWN_ENEMY_ON_MOVE) {
+                    addEnemy();
+                }
             }
-            auto currentController = playerSprite.controller;
-            if (!playerSprite.immobile && enemyEaten < maxEnemyEaten[currentGameMode]) {
-                if (SDL_GameControllerGetButton(currentController, SDL_CONTROLLER_BUTTON_DPAD_UP)) {
-                    playerSprite.bounds.y -= PLAYER_SPEED * deltaTime;
-                    if (playerSprite.bounds.y < -80) { // Wrap around top -> bottom
-                        playerSprite.bounds.y = SCREEN_HEIGHT - playerSprite.bounds.h;
-                    }
-                    if (contains(gameModeModifiers[currentGameMode], "spawnEnemyOnMove")) {
-                        addEnemy();
-                    }
-                } else if (static_cast<float>(SDL_GameControllerGetAxis(currentController, SDL_CONTROLLER_AXIS_LEFTY) / 32768.0f) < -0.1f) {
-                    playerSprite.bounds.y += static_cast<float>(SDL_GameControllerGetAxis(currentController, SDL_CONTROLLER_AXIS_LEFTY)) / 32768 * PLAYER_SPEED * deltaTime;
-                    if (playerSprite.bounds.y < -80) { // Wrap around top -> bottom
-                        playerSprite.bounds.y = SCREEN_HEIGHT - playerSprite.bounds.h;
-                    }
-                    if (contains(gameModeModifiers[currentGameMode], "spawnEnemyOnMove")) {
-                        addEnemy();
-                    }
+            if (inputButton(slot, SDL_CONTROLLER_BUTTON_DPAD_LEFT)) {
+                playerSprite.fx -= PLAYER_SPEED * deltaTime;
+                if (playerSprite.fx < -80) {
+                    playerSprite.fx = SCREEN_WIDTH;
                 }
-                if (SDL_GameControllerGetButton(currentController, SDL_CONTROLLER_BUTTON_DPAD_DOWN)) {
-                    playerSprite.bounds.y += PLAYER_SPEED * deltaTime;
-                    if (playerSprite.bounds.y > SCREEN_HEIGHT - playerSprite.bounds.h + 80) { // Wrap bottom -> top
-                        playerSprite.bounds.y = 0;
-                    }
-                    if (contains(gameModeModifiers[currentGameMode], "spawnEnemyOnMove")) {
-                        addEnemy();
-                    }
-                } else if (static_cast<float>(SDL_GameControllerGetAxis(currentController, SDL_CONTROLLER_AXIS_LEFTY) / 32768.0f) > 0.1f) {
-                    playerSprite.bounds.y += static_cast<float>(SDL_GameControllerGetAxis(currentController, SDL_CONTROLLER_AXIS_LEFTY)) / 32768 * PLAYER_SPEED * deltaTime;
-                    if (playerSprite.bounds.y > SCREEN_HEIGHT - playerSprite.bounds.h + 80) { // Wrap bottom -> top
-                        playerSprite.bounds.y = 0;
-                    }
-                    if (contains(gameModeModifiers[currentGameMode], "spawnEnemyOnMove")) {
-                        addEnemy();
-                    }
+                if (Modifiers & MOD_SPAWN_ENEMY_ON_MOVE) {
+                    addEnemy();
                 }
-                if (SDL_GameControllerGetButton(currentController, SDL_CONTROLLER_BUTTON_DPAD_LEFT)) {
-                    playerSprite.bounds.x -= PLAYER_SPEED * deltaTime;
-                    if (playerSprite.bounds.x < -80) {
-                        playerSprite.bounds.x = SCREEN_WIDTH;
-                    }
-                    if (contains(gameModeModifiers[currentGameMode], "spawnEnemyOnMove")) {
-                        addEnemy();
-                    }
-                } else if (static_cast<float>(SDL_GameControllerGetAxis(currentController, SDL_CONTROLLER_AXIS_LEFTX) / 32768.0f) < -0.1f) {
-                    playerSprite.bounds.x += static_cast<float>(SDL_GameControllerGetAxis(currentController, SDL_CONTROLLER_AXIS_LEFTX)) / 32768 * PLAYER_SPEED * deltaTime;
-                    if (playerSprite.bounds.x < -80) {
-                        playerSprite.bounds.x = SCREEN_WIDTH;
-                    }
-                    if (contains(gameModeModifiers[currentGameMode], "spawnEnemyOnMove")) {
-                        addEnemy();
-                    }
+            } else if (static_cast<float>(inputAxis(slot, SDL_CONTROLLER_AXIS_LEFTX) / 32768.0f) < -0.1f) {
+                playerSprite.fx += static_cast<float>(inputAxis(slot, SDL_CONTROLLER_AXIS_LEFTX)) / 32768 * PLAYER_SPEED * deltaTime;
+                if (playerSprite.fx < -80) {
+                    playerSprite.fx = SCREEN_WIDTH;
                 }
-                if (SDL_GameControllerGetButton(currentController, SDL_CONTROLLER_BUTTON_DPAD_RIGHT)) {
-                    playerSprite.bounds.x += PLAYER_SPEED * deltaTime;
-                    if (playerSprite.bounds.x > SCREEN_WIDTH - playerSprite.bounds.w + 80) {
-                        playerSprite.bounds.x = 0;
-                    }
-                    if (contains(gameModeModifiers[currentGameMode], "spawnEnemyOnMove")) {
-                        addEnemy();
-                    }
-                } else if (static_cast<float>(SDL_GameControllerGetAxis(currentController, SDL_CONTROLLER_AXIS_LEFTX) / 32768.0f) > 0.1f) {
-                    playerSprite.bounds.x += static_cast<float>(SDL_GameControllerGetAxis(currentController, SDL_CONTROLLER_AXIS_LEFTX)) / 32768 * PLAYER_SPEED * deltaTime;
-                    if (playerSprite.bounds.x > SCREEN_WIDTH - playerSprite.bounds.w + 80) {
-                        playerSprite.bounds.x = 0;
-                    }
-                    if (contains(gameModeModifiers[currentGameMode], "spawnEnemyOnMove")) {
-                        addEnemy();
-                    }
+                if (Modifiers & MOD_SPAWN_ENEMY_ON_MOVE) {
+                    addEnemy();
                 }
             }
-            mouths[playerI2].x = playerSprite.bounds.x + 27;
-            mouths[playerI2].y = playerSprite.bounds.y + 88;
-            mouths[playerI2].w = 40;
-            mouths[playerI2].h = 20;
-            if (SDL_GameControllerGetButton(currentController, SDL_CONTROLLER_BUTTON_A)) {
-                if (playerSprite.previousInvulnerable == false) {
-                    playerSprite.texture = IMG_LoadTexture(renderer, playerTransparentImage[currentGameMode]);
+            if (inputButton(slot, SDL_CONTROLLER_BUTTON_DPAD_RIGHT)) {
+                playerSprite.fx += PLAYER_SPEED * deltaTime;
+                if (playerSprite.fx > SCREEN_WIDTH - playerSprite.bounds.w + 80) {
+                    playerSprite.fx = 0;
+                }
+                if (Modifiers & MOD_SPAWN_ENEMY_ON_MOVE) {
+                    addEnemy();
+                }
+            } else if (static_cast<float>(inputAxis(slot, SDL_CONTROLLER_AXIS_LEFTX) / 32768.0f) > 0.1f) {
+                playerSprite.fx += static_cast<float>(inputAxis(slot, SDL_CONTROLLER_AXIS_LEFTX)) / 32768 * PLAYER_SPEED * deltaTime;
+                if (playerSprite.fx > SCREEN_WIDTH - playerSprite.bounds.w + 80) {
+                    playerSprite.fx = 0;
                 }
-                playerSprite.invulnerable = true;
-                playerSprite.immobile = true;
-                playerSprite.previousInvulnerable = true;
-            } else {
-                if (playerSprite.previousInvulnerable == true) {
-                    playerSprite.texture = IMG_LoadTexture(renderer, playerImage[currentGameMode]);
+                if (Modifiers & MOD_SPAWN_ENEMY_ON_MOVE) {
+                    addEnemy();
                 }
-                playerSprite.invulnerable = false;
-                playerSprite.immobile = false;
-                playerSprite.previousInvulnerable = false;
             }
-            playerI2++;
         }
-        if (SDL_GameControllerGetButton(controller, SDL_CONTROLLER_BUTTON_A) && enemyEaten >= maxEnemyEaten[currentGameMode]) {
-            restartGame();
+        playerSprite.bounds.x = static_cast<int>(playerSprite.fx);
+        playerSprite.bounds.y = static_cast<int>(playerSprite.fy);
+        playerSprite.mouth.x = playerSprite.bounds.x + 27;
+        playerSprite.mouth.y = playerSprite.bounds.y + 88;
+        playerSprite.mouth.w = 40;
+        playerSprite.mouth.h = 20;
+        if (inputButton(slot, SDL_CONTROLLER_BUTTON_A)) {
+            if (playerSprite.previousInvulnerable == false) {
+                setSpriteState(playerSprite, SPRITE_STATE_INVULNERABLE);
+            }
+            playerSprite.invulnerable = true;
+            playerSprite.immobile = true;
+            playerSprite.previousInvulnerable = true;
+        } else {
+            if (playerSprite.previousInvulnerable == true) {
+                setSpriteState(playerSprite, SPRITE_STATE_NORMAL);
+            }
+            playerSprite.invulnerable = false;
+            playerSprite.immobile = false;
+            playerSprite.previousInvulnerable = false;
         }
-        
-        int playerI = 0;
-        for (auto& playerSprite : players) {
-            if (playerSprite.controller != nullptr && SDL_GameControllerGetAttached(playerSprite.controller)) {
-                // enemy collision with player
-                for (auto& enemy : enemies) {
-                    if (SDL_HasIntersection(&mouths[playerI], &enemy.bounds) && !playerSprite.invulnerable) {
-                        //if (playerSprite.controllerId == 0) { I might give each player their own enemy eaten but not now
-                            enemyEaten++;
-                        //} else if (playerSprite.controllerId == 1) {
-                            //enemyEaten1++;
-                        //} else if (playerSprite.controllerId == 2) {
-                            //enemyEaten2++;
-                        //} else if (playerSprite.controllerId == 3) {
-                            //enemyEaten3++;
-                        //} else  if (playerSprite.controllerId == 4) {
-                            //enemyEaten4++;
-                        //}
-                        enemy.fx = rng(0, SCREEN_WIDTH - 30);
-                        enemy.fy = rng(0, SCREEN_HEIGHT - 30);
-                    }
-                }
+        playerI2++;
+    }
+    int playerI = 0;
+    for (auto& playerSprite : players) {
+        if (inputAttached(playerI)) {
+            PROFILE_ZONE("collisions");
+            // enemy collision with player. Respawning only moves fx/fy, the
+            // rects stay put until the enemy update, so every hit can be found up front.
+            int enemyLen = enemies.count;
+            if (!playerSprite.invulnerable && intersectRectBatch(playerSprite.mouth, enemies.x.data(), enemies.y.data(), enemies.w.data(), enemies.h.data(), enemyLen, enemyHits.data()) > 0) {
+                forEachHit(enemyHits.data(), enemyLen, [&](int enemyI) {
+                    //if (playerSprite.controllerId == 0) { I might give each player their own enemy eaten but not now
+                        enemyEaten++;
+                    //} else if (playerSprite.controllerId == 1) {
+                        //enemyEaten1++;
+                    //} else if (playerSprite.controllerId == 2) {
+                        //enemyEaten2++;
+                    //} else if (playerSprite.controllerId == 3) {
+                        //enemyEaten3++;
+                    //} else  if (playerSprite.controllerId == 4) {
+                        //enemyEaten4++;
+                    //}
+                    enemies.fx[enemyI] = rng(0, SCREEN_WIDTH - 30, RNG_RESPAWN);
+                    enemies.fy[enemyI] = rng(0, SCREEN_HEIGHT - 30, RNG_RESPAWN);
+                });
+            }
 
-                // token collision with player
-                for (auto& token : tokens) {
-                    if (SDL_HasIntersection(&mouths[playerI], &token.bounds)) {
-                        Mix_PlayChannel(-1, sound, 0); // Play collision sound
-                        tokenseaten++;                        // Increment tokenseaten
-                        token.fx = rng(0, SCREEN_WIDTH - 30);
-                        token.fy = rng(0, SCREEN_HEIGHT - 30);
-                        if (tokenseaten % 3 == 0) {
-                            addEnemy();
-                        }
+            // token collision with player
+            int tokenLen = tokens.count;
+            if (intersectRectBatch(playerSprite.mouth, tokens.x.data(), tokens.y.data(), tokens.w.data(), tokens.h.data(), tokenLen, tokenHits.data()) > 0) {
+                forEachHit(tokenHits.data(), tokenLen, [&](int tokenI) {
+                    Mix_PlayChannel(-1, sound, 0); // Play collision sound
+                    tokenseaten++;                        // Increment tokenseaten
+                    tokens.fx[tokenI] = rng(0, SCREEN_WIDTH - 30, RNG_RESPAWN);
+                    tokens.fy[tokenI] = rng(0, SCREEN_HEIGHT - 30, RNG_RESPAWN);
+                    if (tokenseaten % 3 == 0) {
+                        addEnemy();
                     }
-                }
+                });
             }
-            playerI++;
         }
+        playerI++;
+    }
 
-        if (contains(gameModeModifiers[currentGameMode], "angryCelery")) {
-            evilEnemyTimer--;
-            if (evilEnemyTimer <= 0) {
-                enemies[0].evil = true;
-                enemies[0].evilTimer = 900;
-                evilEnemyTimer = 1800;
-            }
+    if (Modifiers & MOD_ANGRY_CELERY) {
+        evilEnemyTimer--;
+        if (evilEnemyTimer <= 0 && enemies.count > 0) {
+            enemies.evilTimer[0] = 900;
+            evilEnemyTimer = 1800;
         }
+    }
 
-        // update the enemies
-        int i = 0;
-        for (auto& enemy : enemies) {
-            int enemyLen = static_cast<int>(enemies.size());
-            int tokenLen = static_cast<int>(tokens.size());
-            if (enemyLen % 4 == 0 && !(contains(gameModeModifiers[currentGameMode], "noCircle"))) {
-                enemy.protectingToken = true;
-            } else {
-                enemy.protectingToken = false;
-            }
-            if (!enemy.protectingToken) {
-                enemy.fx += enemy.hv * deltaTime;
-                enemy.fy += enemy.vv * deltaTime;
-            } else {
-                int tokenIToCircle = static_cast<int>(std::floor(static_cast<float>(i) / (static_cast<float>(enemyLen) / static_cast<float>(tokenLen))));
-                int distanceToToken = distance(enemy, tokens[tokenIToCircle]);
-                if (distanceToToken >= 200) {
-                    // Attract the enemy towards the token
-                    attract(enemy, tokens[tokenIToCircle]);
-                    // Update float positions
-                    enemy.fx += enemy.hv * deltaTime;
-                    enemy.fy += enemy.vv * deltaTime;
-                } else {
-                    // Circle around the token
-                    circleAroundObject(tokens[tokenIToCircle], enemy, 190);
-                }
-            }
+    // update the enemies, on the job system (src/enemy_update.cpp)
+    if ((Modifiers & MOD_STRESS) && budgetLevel == BUDGET_FULL) {
+        addEnemies(STRESS_SPAWN_PER_TICK);
+    }
 
-            if (contains(gameModeModifiers[currentGameMode], "enemiesBounce")) {
-                int ii = 0;
-                for (auto& enemy2 : enemies) {
-                    if (SDL_HasIntersection(&enemy.bounds, &enemy2.bounds) && i != ii) {
-                        enemy.hv = -enemy.hv;
-                        enemy.vv = -enemy.vv;
-                        enemy.fx += enemy.hv * deltaTime * 3;
-                        enemy.fy += enemy.vv * deltaTime * 3;
-                    }
-                    ii++;
-                }
-            }
+    int enemyLen = enemies.count;
+    int tokenLen = tokens.count;
+    bool protectingToken = enemyLen % 4 == 0 && !(Modifiers & MOD_NO_CIRCLE) && tokenLen > 0 && budgetLevel < BUDGET_NO_ORBIT;
+    bool bouncing = (Modifiers & MOD_ENEMIES_BOUNCE) && budgetLevel < BUDGET_NO_BOUNCE;
 
-            if (enemy.evilTimer > 0) {
-                --enemy.evilTimer;
-                if (enemy.evilTimer == 899) {
-                    enemy.texture = IMG_LoadTexture(renderer, "sprites/red_celery.png");
-                    enemy.hv *= 3;
-                    enemy.vv *= 3;
-                } else if (enemy.evilTimer == 1) {
-                    enemy.texture = IMG_LoadTexture(renderer, enemyImage[currentGameMode]);
-                    enemy.hv /= 3;
-                    enemy.vv /= 3;
-                }
-            }
+    // Scratch is sized up front, the enemy loop itself must not allocate
+    reserveEnemyScratch(enemyLen);
+    if (bouncing) {
+        reserveBounceCandidates(enemyJobCandidates, enemyLen, enemyGrid);
+    }
+    if (protectingToken) {
+        updateOrbitAssignments(enemyLen, tokenLen);
+    }
+    if (Modifiers & MOD_HUNTER) {
+        PROFILE_ZONE("flowField");
+        updateHunterField();
+    }
+    Uint64 allocationsBefore = allocationCount();
+
+    EnemyPass pass;
+    pass.enemies = &enemies;
+    pass.tokens = &tokens;
+    pass.orbitTokenForEnemy = protectingToken ? orbitTokenForEnemy.data() : nullptr;
+    pass.hunterField = &hunterField;
+    pass.bounceGrid = bouncing ? &enemyGrid : nullptr;
+    pass.scratch = &enemyJobCandidates;
+    pass.deltaTime = deltaTime;
+    updateEnemies<(Modifiers & MOD_HUNTER) != 0, (Modifiers & MOD_ANGRY_CELERY) != 0>(pass);
+
+    // Replays tick with nothing else running, so the count is the enemy loop's own
+    if (isReplaying) {
+        Uint64 allocated = allocationCount() - allocationsBefore;
+        enemyLoopAllocations += allocated;
+        SDL_assert(allocated == 0);
+    }
+
+    // Shared state is only touched back on this thread, in enemy order
+    PROFILE_ZONE("spatialGrid");
+    for (int i = 0; i < enemyLen; i++) {
+        updateSpatialGridItem(enemyGrid, i, entityBounds(enemies, i));
+    }
+
+    // Move the tokens
+    for (int tokenI = 0; tokenI < tokenLen; tokenI++) {
+        //tokens.fx[tokenI] += tokens.hv[tokenI] * deltaTime;
+        //tokens.fy[tokenI] += tokens.vv[tokenI] * deltaTime;
+        tokens.x[tokenI] = tokens.fx[tokenI];
+        tokens.y[tokenI] = tokens.fy[tokenI];
+    }
+}
+
+void (*const updateGameForMode[])(float) = {
+    updateGame<gameModeModifiers[0]>,
+    updateGame<gameModeModifiers[1]>,
+    updateGame<gameModeModifiers[2]>,
+    updateGame<gameModeModifiers[3]>,
+    updateGame<gameModeModifiers[4]>,
+    updateGame<gameModeModifiers[5]>
+};
+
+static_assert(sizeof(updateGameForMode) / sizeof(updateGameForMode[0]) == sizeof(gameModeModifiers) / sizeof(gameModeModifiers[0]), "every game mode needs an update function");
+
+// Screens, one typed state each. Transitions go through changeScreen() so the
+// enter/exit hooks can set up and tear down what a screen needs. Everything
+// here runs on the simulation thread; render() only sees the screen through
+// the snapshot.
+enum GameScreen {
+    SCREEN_MENU,
+    SCREEN_PLAYING,
+    SCREEN_PAUSED,
+    SCREEN_GAME_OVER,
+    SCREEN_COUNT
+};
+
+struct ScreenState {
+    void (*enter)(GameScreen from);                         // optional
+    void (*exit)(GameScreen to);                            // optional
+    void (*update)(float deltaTime);                        // nullptr holds the game still
+    void (*render)(const FrameSnapshot& frame, float alpha); // render thread, from the snapshot
+};
+
+extern const ScreenState screens[SCREEN_COUNT];
+
+GameScreen currentScreen = SCREEN_MENU;
+GameScreen resumeScreen = SCREEN_PLAYING;  // where unpausing goes back to
+
+void changeScreen(GameScreen next) {
+    if (next == currentScreen) {
+        return;
+    }
+    GameScreen previous = currentScreen;
+    if (screens[previous].exit != nullptr) {
+        screens[previous].exit(next);
+    }
+    currentScreen = next;
+    if (screens[next].enter != nullptr) {
+        screens[next].enter(previous);
+    }
+}
+
+// Sprites of the mode selected in the menu. Holding them means starting that
+// mode never decodes anything, and releasing the last round can't unload them.
+const int PRELOAD_IMAGES = 5;
+const SpriteImage* preloadedImages[PRELOAD_IMAGES] = {};
+size_t preloadedMode = SIZE_MAX;
+
+void preloadMode(size_t mode) {
+    if (mode == preloadedMode || !gameInitialized) {
+        return;
+    }
+    // Take the new references before dropping the old ones, the modes share most sprites
+    const char* paths[PRELOAD_IMAGES] = {playerImage[mode], playerTransparentImage[mode], tokenImage[mode], enemyImage[mode], angryEnemyImage[mode]};
+    const SpriteImage* previous[PRELOAD_IMAGES];
+    for (int i = 0; i < PRELOAD_IMAGES; i++) {
+        previous[i] = preloadedImages[i];
+        preloadedImages[i] = acquireImage(renderer, paths[i]);
+    }
+    for (int i = 0; i < PRELOAD_IMAGES; i++) {
+        if (previous[i] != nullptr) {
+            releaseImage(previous[i]);
+        }
+    }
+    preloadedMode = mode;
+
+    // Size the enemy scratch for the mode's limit now rather than while it spawns
+    reserveEnemyScratch(maxEnemies[mode]);
+    orbitTokenForEnemy.reserve(maxEnemies[mode]);
+}
 
-            // Bounce off left/right edges
-            if (enemy.fx < 0) {
-                enemy.fx = 0;       // prevent going offscreen
-                enemy.hv *= -1;     // reverse X velocity
+// Drops the round's sprites when going back to the menu. The stores keep their
+// capacity, so the next round spawns into the same memory.
+void releaseRound() {
+    clearEntities(enemies);
+    clearEntities(tokens);
+    for (auto& player : players) {
+        releaseSprite(player);
+    }
+    players.clear();
+    resetSpatialGrid(enemyGrid);
+}
+
+// First game objects, once the sprite atlas and sounds are in
+void initGame() {
+    playerSprite = loadSprite(renderer, "sprites/NicCageFace.png", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+    enemySprite = loadSprite(renderer, "sprites/celery.png", rng(0, SCREEN_WIDTH), rng(0, SCREEN_HEIGHT));
+    restartGame();
+    gameInitialized = true;
+    preloadMode(currentGameMode);
+}
+
+void enterMenu(GameScreen from) {
+    if (from != SCREEN_MENU) {
+        releaseRound();
+    }
+    preloadMode(currentGameMode);
+}
+
+void updateMenu(float) {
+    if (inputPlayerIndex(0) >= 0 && inputAttached(0)) {
+        if (inputButton(0, SDL_CONTROLLER_BUTTON_A) && gameInitialized) {
+            changeScreen(SCREEN_PLAYING);
+        }
+        if (inputButton(0, SDL_CONTROLLER_BUTTON_DPAD_LEFT)) {
+            if (currentGameMode > 0 && !previousLeft) {
+                currentGameMode--;
             }
-            else if (enemy.fx > SCREEN_WIDTH - enemy.bounds.w) {
-                enemy.fx = SCREEN_WIDTH - enemy.bounds.w;
-                enemy.hv *= -1;
+            previousLeft = true;
+        } else {
+            previousLeft = false;
+        }
+        if (inputButton(0, SDL_CONTROLLER_BUTTON_DPAD_RIGHT)) {
+            //int gameModeLength = sizeof(gameModeNames);
+            size_t gameModeLength = sizeof(gameModeNames) / sizeof(gameModeNames[0]);
+            if (currentGameMode < (gameModeLength - 1) && !previousRight) {
+                currentGameMode++;
             }
-
-            // Bounce off top/bottom edges
-            if (enemy.fy < 0) {
-                enemy.fy = 0;
-                enemy.vv *= -1;     // reverse Y velocity
+            previousRight = true;
+        } else {
+            previousRight = false;
+        }
+    } else {
+        if (inputButton(1, SDL_CONTROLLER_BUTTON_A) && gameInitialized) {
+            changeScreen(SCREEN_PLAYING);
+        }
+        if (inputButton(1, SDL_CONTROLLER_BUTTON_DPAD_LEFT)) {
+            if (currentGameMode > 0 && !previousLeft) {
+                currentGameMode--;
             }
-            else if (enemy.fy > SCREEN_HEIGHT - enemy.bounds.h) {
-                enemy.fy = SCREEN_HEIGHT - enemy.bounds.h;
-                enemy.vv *= -1;
+            previousLeft = true;
+        } else {
+            previousLeft = false;
+        }
+        if (inputButton(1, SDL_CONTROLLER_BUTTON_DPAD_RIGHT)) {
+            //int gameModeLength = sizeof(gameModeNames);
+            size_t gameModeLength = sizeof(gameModeNames) / sizeof(gameModeNames[0]);
+            if (currentGameMode < (gameModeLength - 1) && !previousRight) {
+                currentGameMode++;
             }
-
-            // Update SDL_Rect for rendering
-            enemy.bounds.x = static_cast<int>(enemy.fx);
-            enemy.bounds.y = static_cast<int>(enemy.fy);
-            enemy.bounds.x = enemy.fx;
-            enemy.bounds.y = enemy.fy;
-            i++;
+            previousRight = true;
+        } else {
+            previousRight = false;
         }
+    }
+    // Load the newly selected mode while the menu is showing
+    preloadMode(currentGameMode);
+}
 
-        // Move the tokens
-        for (auto& token : tokens) {
-            //token.fx += token.hv * deltaTime;
-            //token.fy += token.vv * deltaTime;
-            token.bounds.x = token.fx;
-            token.bounds.y = token.fy;
-        }
+void enterPlaying(GameScreen from) {
+    // Unpausing carries on with the same round
+    if (from == SCREEN_MENU || from == SCREEN_GAME_OVER) {
+        restartGame();
     }
 }
 
-// ------------------ RENDERING ------------------
-void renderSprite(Sprite &sprite) {
-    // Draw the sprite texture at its current bounds
-    SDL_RenderCopy(renderer, sprite.texture, NULL, &sprite.bounds);
+void updatePlaying(float deltaTime) {
+    updateGameForMode[currentGameMode](deltaTime);
+    if (enemyEaten >= maxEnemyEaten[currentGameMode]) {
+        changeScreen(SCREEN_GAME_OVER);
+    }
 }
 
-void drawText(SDL_Renderer* renderer, std::string text, int x, int y, SDL_Color color = colors[8], std::string positioning = "") {
-    SDL_Texture *textTexture = nullptr;
-    updateTextureText(textTexture, text.c_str(), font, renderer, color);
-    SDL_Rect textBounds;
-
-    SDL_QueryTexture(textTexture, NULL, NULL, &textBounds.w, &textBounds.h);
-    textBounds.y = y;
-    textBounds.x = x;
-    if (positioning == "center") {
-        textBounds.x = x - textBounds.w / 2;
-    } else if (positioning == "right") {
-        textBounds.x = x - textBounds.w;
-    }
-    SDL_RenderCopy(renderer, textTexture, NULL, &textBounds);
-    SDL_DestroyTexture(textTexture);
+// The round keeps simulating behind the end screen, as it always has
+void updateGameOver(float deltaTime) {
+    if (inputButton(0, SDL_CONTROLLER_BUTTON_A)) {
+        changeScreen(SCREEN_PLAYING);
+        updatePlaying(deltaTime);
+        return;
+    }
+    updateGameForMode[currentGameMode](deltaTime);
 }
 
-void render() {
-    int backgroundColors = 255;
-    if (currentScreen == "game" && contains(gameModeModifiers[currentGameMode], "blackEndScreen") && enemyEaten >= maxEnemyEaten[currentGameMode]) {
-        backgroundColors = 0;
+void update(float deltaTime) {
+    PROFILE_ZONE("update");
+    screens[currentScreen].update(deltaTime);
+}
+
+// Snapshot positions before a tick so render() can interpolate towards the new ones
+void storePreviousState() {
+    for (auto& player : players) {
+        player.prevFx = player.fx;
+        player.prevFy = player.fy;
     }
-    SDL_SetRenderDrawColor(renderer, backgroundColors, backgroundColors, backgroundColors, 255); // white background
-    SDL_RenderClear(renderer);
+    storePreviousPositions(enemies);
+    storePreviousPositions(tokens);
+}
 
-    //drawText(renderer, std::to_string(SDL_GameControllerGetAttached(controller)), 0, 200);
-    //drawText(renderer, std::to_string(SDL_GameControllerGetAttached(controller1)), 0, 300);
-    //drawText(renderer, std::to_string(SDL_GameControllerGetAttached(controller2)), 0, 400);
-    //drawText(renderer, std::to_string(SDL_GameControllerGetAttached(controller3)), 0, 500);
-    //drawText(renderer, std::to_string(SDL_GameControllerGetAttached(controller4)), 0, 600);
-
-    //drawText(renderer, std::to_string(SDL_GameControllerGetPlayerIndex(controller)), 100, 200);
-    //drawText(renderer, std::to_string(SDL_GameControllerGetPlayerIndex(controller1)), 100, 300);
-    //drawText(renderer, std::to_string(SDL_GameControllerGetPlayerIndex(controller2)), 100, 400);
-    //drawText(renderer, std::to_string(SDL_GameControllerGetPlayerIndex(controller3)), 100, 500);
-    //drawText(renderer, std::to_string(SDL_GameControllerGetPlayerIndex(controller4)), 100, 600);
-
-    if (currentScreen == "menu") {
-        // Update selected game text
-        drawText(renderer, "Game: " + gameModeNames[currentGameMode], SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 50, colors[8], "center");
-
-        // Update navigation text
-        drawText(renderer, "A: Select    D-PAD: Navigate", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 50, colors[8], "center");
-    }
-    if (currentScreen == "game") {
-        // Draw player
-        if (enemyEaten < maxEnemyEaten[currentGameMode]) {
-            //renderSprite(playerSprite);
-            int i = 0;
-            for (auto& player : players) {
-                //drawText(renderer, std::to_string(SDL_GameControllerGetAttached(player.controller)), 50, 200 + (i * 100));
-                //drawText(renderer, std::to_string(SDL_GameControllerGetPlayerIndex(player.controller)), 150, 200 + (i * 100));
-                //drawText(renderer, std::to_string(player.controllerId), 200, 200 + (i * 100));
-                if (player.controller != nullptr && SDL_GameControllerGetAttached(player.controller)) {
-                    renderSprite(player); // same function as before
-                    if (controller1 != nullptr && SDL_GameControllerGetAttached(controller1)) {
-                        drawText(renderer, std::to_string(SDL_GameControllerGetPlayerIndex(player.controller)), player.bounds.x, player.bounds.y + player.bounds.w);
-                    }
+void applyInputCommands() {
+    if (currentInput.commands & INPUT_COMMAND_MENU) {
+        changeScreen(SCREEN_MENU);
+    }
+
+    // Only a round can be paused, the menu has nothing to hold still
+    if ((currentInput.commands & INPUT_COMMAND_PAUSE) && currentScreen != SCREEN_MENU) {
+        if (currentScreen == SCREEN_PAUSED) {
+            changeScreen(resumeScreen);
+        } else {
+            resumeScreen = currentScreen;
+            changeScreen(SCREEN_PAUSED);
+        }
+        if (gameInitialized) { // the sound may still be loading before that
+            Mix_PlayChannel(-1, sound, 0); // Play sound effect
+        }
+    }
+}
+
+void addSnapshotSprites(FrameSnapshot& frame, const EntityStore& store) {
+    for (int i = 0; i < store.count; i++) {
+        frame.sprites.push_back({store.image[i], store.prevFx[i], store.prevFy[i], store.fx[i], store.fy[i], store.w[i], store.h[i]});
+    }
+}
+
+// Copy what render() needs out of the live state and hand it to the renderer
+void publishFrameSnapshot() {
+    PROFILE_ZONE("publishSnapshot");
+    FrameSnapshot& frame = snapshotForWriting();
+    frame.tick = simulationTick;
+    frame.publishedAt = SDL_GetPerformanceCounter();
+    frame.screen = currentScreen;
+    frame.gameMode = static_cast<int>(currentGameMode);
+    frame.enemyEaten = enemyEaten;
+    frame.tokensEaten = tokenseaten;
+    frame.enemyCount = enemies.count;
+    frame.budgetLevel = budgetLevel;
+    frame.sprites.clear();
+    frame.labels.clear();
+
+    if (currentScreen != SCREEN_MENU && enemyEaten < maxEnemyEaten[currentGameMode]) {
+        for (int i = 0; i < static_cast<int>(players.size()); i++) {
+            const Sprite& player = players[i];
+            if (inputAttached(i)) {
+                frame.sprites.push_back({player.image, player.prevFx, player.prevFy, player.fx, player.fy, player.bounds.w, player.bounds.h});
+                if (inputAttached(1)) {
+                    frame.labels.push_back({inputPlayerIndex(i), player.bounds.x, player.bounds.y + player.bounds.w});
                 }
-                i++;
             }
+        }
+        addSnapshotSprites(frame, enemies);
+        addSnapshotSprites(frame, tokens);
+    }
 
-            for (auto& enemy : enemies) {
-                renderSprite(enemy); // same function as before
-            }
+    publishSnapshot();
+}
 
-            for (auto& token : tokens) {
-                renderSprite(token); // same function as before
-            }
+// Run one simulation tick with live or replayed input, false once a replay has run out
+bool simulateTick() {
+    PROFILE_ZONE("tick");
+    setTextureReleaseTick(simulationTick + 1); // the snapshot this tick publishes
+    if (isReplaying) {
+        if (!nextReplayInput(currentInput)) {
+            return false;
         }
+    } else {
+        takeLiveInput(currentInput);
+    }
+    recordInput(currentInput);
+
+    // Live play reaches the menu before the sprites are loaded
+    if (!gameInitialized && gameAssetsReady.load(std::memory_order_acquire)) {
+        initGame();
+    }
 
-        // Draw pause message if game is paused
-        if (isGamePaused) {
-            SDL_RenderCopy(renderer, pauseTexture, NULL, &pauseBounds);
+    applyInputCommands();
+    if (screens[currentScreen].update != nullptr) { // Paused screens hold the game still
+        Uint64 updateStart = SDL_GetPerformanceCounter();
+        storePreviousState();
+        update(SIM_TICK);
+        // Recorded and replayed runs keep full quality, wall-clock timings would make them diverge
+        if (hasModifier(MOD_STRESS) && !isReplaying && !isRecording) {
+            double updateSeconds = (SDL_GetPerformanceCounter() - updateStart) / static_cast<double>(SDL_GetPerformanceFrequency());
+            budgetLevel = updateFrameBudget(updateSeconds);
         }
+    }
+    simulationTick++;
+    publishFrameSnapshot();
+    return true;
+}
 
-        // Update celery eaten text
-        std::string enemyEatenString = "";
-        int enemyEatenColor = 3;
-        if (enemyEaten < maxEnemyEaten[currentGameMode]) {
-            enemyEatenString = enemyToCollectText[currentGameMode] + std::to_string(enemyEaten) + "/" + std::to_string(maxEnemyEaten[currentGameMode]);
-        } else {
-            enemyEatenString = gameOverText[currentGameMode];
-            if (contains(gameModeModifiers[currentGameMode], "blackEndScreen")) {
-                enemyEatenColor = 1;
-            }
+// Live play ticks on its own thread so a present blocked on vsync never
+// holds up the simulation. Owns all game state while it runs.
+void simulationLoop() {
+    const double counterFrequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    const double maxFrameTime = 0.25;  // after a long stall, drop time instead of fast-forwarding
+    const int maxTicksPerFrame = 5;    // catch up at most this many ticks at once
+    Uint64 previousCounter = SDL_GetPerformanceCounter();
+    double accumulator = 0.0;
+    Uint32 textureLogTime = SDL_GetTicks();
+
+    while (isSimulationRunning.load(std::memory_order_acquire)) {
+        Uint64 currentCounter = SDL_GetPerformanceCounter();
+        accumulator += SDL_min((currentCounter - previousCounter) / counterFrequency, maxFrameTime);
+        previousCounter = currentCounter;
+
+        int ticks = 0;
+        while (accumulator >= SIM_TICK && ticks < maxTicksPerFrame) {
+            simulateTick();
+            accumulator -= SIM_TICK;
+            ticks++;
         }
-        int enemyEatenX = 32;
-        std::string enemyEatenPosition = "";
-        if (contains(gameModeModifiers[currentGameMode], "altUI")) {
-            if (enemyEaten >= maxEnemyEaten[currentGameMode]) {
-                enemyEatenX = 0;
-            } else {
-                enemyEatenX = SCREEN_WIDTH - 400;
-                enemyEatenPosition = "right";
-            }
+        if (ticks == maxTicksPerFrame && accumulator >= SIM_TICK) {
+            accumulator = 0.0;   // too far behind, let the game slow down instead of spiralling
         }
-        drawText(renderer, enemyEatenString, enemyEatenX, 0, colors[enemyEatenColor], enemyEatenPosition);
 
-        // Update tokenseaten text
-        int tokensEatenColor = 8;
-        if (enemyEaten >= maxEnemyEaten[currentGameMode] && contains(gameModeModifiers[currentGameMode], "blackEndScreen")) {
-            tokensEatenColor = 1;
-        }
-        int tokensEatenX = 32;
-        int tokensEatenY = 40;
-        SDL_QueryTexture(tokenseatenTexture, NULL, NULL, &tokenseatenBounds.w, &tokenseatenBounds.h);
-        if (contains(gameModeModifiers[currentGameMode], "altUI")) {
-            tokensEatenX = SCREEN_WIDTH - tokenseatenBounds.w;
-            tokensEatenY = 0;
+        // Texture memory should stay flat however long a session runs
+        if (SDL_GetTicks() - textureLogTime >= 60000) {
+            logTextureStats();
+            textureLogTime = SDL_GetTicks();
         }
-        drawText(renderer, tokenToCollectText[currentGameMode] + std::to_string(tokenseaten), tokensEatenX, tokensEatenY, colors[tokensEatenColor], enemyEatenPosition);
 
-        // Update misc1 text
-        std::string miscString1 = "";
-        int enemyLen = static_cast<int>(enemies.size());
-        if (enemyLen >= 200) {
-            miscString1 = "Enemy limit of 200 reached!";
+        // Sleep until the next tick is due
+        SDL_Delay(static_cast<Uint32>(SDL_max(SIM_TICK - accumulator, 0.0) * 1000.0));
+    }
+}
+
+// ------------------ RENDERING ------------------
+// Sprites are only queued here, flushSpriteBatch() draws them
+void renderSprites(const FrameSnapshot& frame, float alpha) {
+    for (const auto& sprite : frame.sprites) {
+        // Draw the sprite between its previous and current position
+        SDL_Rect bounds;
+        bounds.x = static_cast<int>(interpolatePosition(sprite.prevX, sprite.x, alpha));
+        bounds.y = static_cast<int>(interpolatePosition(sprite.prevY, sprite.y, alpha));
+        bounds.w = sprite.w;
+        bounds.h = sprite.h;
+        queueSprite(sprite.image, bounds);
+    }
+}
+
+// Boot assets, the loader decodes them and the render thread uploads them here
+int fontLoad = -1;
+int spriteLoad = -1;
+int soundLoad = -1;
+int musicLoad = -1;
+bool menuAssetsReady = false;
+bool bootAssetsDone = false;
+Uint64 bootStartCounter = 0;
+
+void queueBootAssets() {
+    AssetLoad load;
+    // The menu only needs the font, so it goes first
+    load.kind = ASSET_FONT;
+    load.path = "fonts/cour.ttf";
+    load.fontSize = 36;
+    fontLoad = queueAssetLoad(load);
+
+    load = AssetLoad();
+    load.kind = ASSET_SPRITE_ATLAS;
+    load.path = "sprites";
+    spriteAtlasLimits(renderer, load.atlasMaxWidth, load.atlasMaxHeight);
+    spriteLoad = queueAssetLoad(load);
+
+    load = AssetLoad();
+    load.kind = ASSET_SOUND;
+    load.path = "sounds/pop1.wav";
+    soundLoad = queueAssetLoad(load);
+
+    load = AssetLoad();
+    load.kind = ASSET_MUSIC;
+    load.path = "music/background.ogg";
+    musicLoad = queueAssetLoad(load);
+}
+
+// Picks up whatever the loader finished since the last call. Only runs on the
+// render thread; true once everything is in.
+bool finishBootAssets() {
+    if (bootAssetsDone) {
+        return true;
+    }
+
+    AssetLoad* load = nullptr;
+    if (!menuAssetsReady && (load = finishedAssetLoad(fontLoad)) != nullptr) {
+        font = load->font;
+        buildGlyphAtlas(renderer, font);
+
+        // Initialize tokenseaten and pause textures
+        updateTextureText(enemyEatenTexture, "Celery Eaten: 0/3", font, renderer, colors[3]);
+        updateTextureText(tokenseatenTexture, "Chicken Eaten: 0", font, renderer, colors[8]);
+        updateTextureText(pauseTexture, "GAME PAUSED. Press - to change game.", font, renderer, colors[8]);
+
+        SDL_QueryTexture(pauseTexture, NULL, NULL, &pauseBounds.w, &pauseBounds.h);
+        pauseBounds.x = SCREEN_WIDTH / 2 - pauseBounds.w / 2;
+        pauseBounds.y = 200;
+        menuAssetsReady = true;
+        printf("Startup: menu ready after %.1f ms\n", (SDL_GetPerformanceCounter() - bootStartCounter) * 1000.0 / SDL_GetPerformanceFrequency());
+    }
+    if (spriteLoad >= 0 && (load = finishedAssetLoad(spriteLoad)) != nullptr) {
+        // Pack the sprites before anything loads them so they all come from the atlas.
+        // Without it every sprite would be created wherever it is first used, so give up.
+        spriteLoad = -1;
+        if (load->failed || !uploadSpriteAtlas(renderer, load->atlas)) {
+            SDL_LogCritical(SDL_LOG_CATEGORY_APPLICATION, "Failed to load the sprite atlas, quitting");
+            isGameRunning = false;
+            return false;
         }
-        if (miscString1 != "") {
-            drawText(renderer, miscString1, 32, 80, colors[8]);
+    }
+    if (soundLoad >= 0 && (load = finishedAssetLoad(soundLoad)) != nullptr) {
+        sound = load->sound;
+        soundLoad = -1;
+    }
+    if (musicLoad >= 0 && (load = finishedAssetLoad(musicLoad)) != nullptr) {
+        music = load->music;
+        Mix_PlayMusic(music, -1); // Play background music in loop
+        musicLoad = -1;
+    }
+
+    if (menuAssetsReady && spriteLoad < 0 && soundLoad < 0 && !gameAssetsReady.load(std::memory_order_relaxed)) {
+        gameAssetsReady.store(true, std::memory_order_release);
+    }
+    bootAssetsDone = gameAssetsReady.load(std::memory_order_relaxed) && musicLoad < 0;
+    if (bootAssetsDone) {
+        printf("Startup: assets loaded in %.1f ms from %s\n", (SDL_GetPerformanceCounter() - bootStartCounter) * 1000.0 / SDL_GetPerformanceFrequency(), assetArchiveOpen() ? ARCHIVE_NAME : "loose files");
+    }
+    return bootAssetsDone;
+}
+
+// Shown until the menu's font is in, the font is what it would need for text
+void renderLoadingScreen() {
+    int finished = 0;
+    int total = 0;
+    assetLoadProgress(finished, total);
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    SDL_Rect bar = {SCREEN_WIDTH / 2 - 300, SCREEN_HEIGHT / 2 - 20, 600, 40};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderDrawRect(renderer, &bar);
+    if (total > 0) {
+        SDL_Rect filled = {bar.x + 4, bar.y + 4, (bar.w - 8) * finished / total, bar.h - 8};
+        SDL_RenderFillRect(renderer, &filled);
+    }
+    SDL_RenderPresent(renderer);
+}
+
+// Everything the HUD shows. The widgets are only touched when one of these
+// changes, so an unchanged HUD builds no strings and no geometry.
+struct HudBindings {
+    int screen = -1;
+    bool loading = false;
+    int gameMode = -1;
+    int enemyEaten = -1;
+    int tokensEaten = -1;
+    int enemyCount = -1;
+    int budgetLevel = -1;
+
+    bool operator==(const HudBindings& other) const {
+        return screen == other.screen && loading == other.loading && gameMode == other.gameMode && enemyEaten == other.enemyEaten &&
+            tokensEaten == other.tokensEaten && enemyCount == other.enemyCount && budgetLevel == other.budgetLevel;
+    }
+};
+
+struct Hud {
+    HudBindings bound;
+    bool fontReady = false;
+    TextWidget gameName, navigation, loading;                 // menu
+    TextWidget enemyEaten, tokensEaten, misc;                 // in game
+    std::vector<TextWidget> labels;                           // player numbers
+    TextWidget frameWork;                                     // while profiling
+    Uint64 boundAllocations = ~0ull;
+    Uint32 boundUploads = ~0u;
+    char buffer[128];
+};
+
+Hud hud;
+
+void layoutHud(const HudBindings& values) {
+    // Menu
+    setWidgetText(hud.gameName, "Game: " + gameModeNames[values.gameMode]);
+    setWidgetLayout(hud.gameName, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 50, TEXT_ALIGN_CENTER);
+    setWidgetText(hud.navigation, "A: Select    D-PAD: Navigate");
+    setWidgetLayout(hud.navigation, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 50, TEXT_ALIGN_CENTER);
+    setWidgetText(hud.loading, "Loading...");
+    setWidgetLayout(hud.loading, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 150, TEXT_ALIGN_CENTER);
+    hud.loading.visible = values.loading;
+
+    // Celery eaten text
+    bool gameOver = values.enemyEaten >= maxEnemyEaten[values.gameMode];
+    bool blackEndScreen = gameOver && modeHasModifier(values.gameMode, MOD_BLACK_END_SCREEN);
+    if (!gameOver) {
+        snprintf(hud.buffer, sizeof(hud.buffer), "%s%d/%d", enemyToCollectText[values.gameMode].c_str(), values.enemyEaten, maxEnemyEaten[values.gameMode]);
+        setWidgetText(hud.enemyEaten, hud.buffer);
+    } else {
+        setWidgetText(hud.enemyEaten, gameOverText[values.gameMode]);
+    }
+    setWidgetColor(hud.enemyEaten, colors[blackEndScreen ? 1 : 3]);
+    int enemyEatenX = 32;
+    TextAlign enemyEatenAlign = TEXT_ALIGN_LEFT;
+    if (modeHasModifier(values.gameMode, MOD_ALT_UI)) {
+        if (gameOver) {
+            enemyEatenX = 0;
+        } else {
+            enemyEatenX = SCREEN_WIDTH - 400;
+            enemyEatenAlign = TEXT_ALIGN_RIGHT;
         }
     }
+    setWidgetLayout(hud.enemyEaten, enemyEatenX, 0, enemyEatenAlign);
+
+    // Tokens eaten text
+    snprintf(hud.buffer, sizeof(hud.buffer), "%s%d", tokenToCollectText[values.gameMode].c_str(), values.tokensEaten);
+    setWidgetText(hud.tokensEaten, hud.buffer);
+    setWidgetColor(hud.tokensEaten, colors[blackEndScreen ? 1 : 8]);
+    int tokensEatenX = 32;
+    int tokensEatenY = 40;
+    if (modeHasModifier(values.gameMode, MOD_ALT_UI)) {
+        SDL_QueryTexture(tokenseatenTexture, NULL, NULL, &tokenseatenBounds.w, &tokenseatenBounds.h);
+        tokensEatenX = SCREEN_WIDTH - tokenseatenBounds.w;
+        tokensEatenY = 0;
+    }
+    setWidgetLayout(hud.tokensEaten, tokensEatenX, tokensEatenY, enemyEatenAlign);
+
+    // Misc1 text
+    hud.misc.visible = true;
+    if (values.enemyCount >= maxEnemies[values.gameMode]) {
+        snprintf(hud.buffer, sizeof(hud.buffer), "Enemy limit of %d reached!", maxEnemies[values.gameMode]);
+    } else if (modeHasModifier(values.gameMode, MOD_STRESS)) {
+        snprintf(hud.buffer, sizeof(hud.buffer), "Enemies: %d (%s)", values.enemyCount, budgetLevelName(static_cast<BudgetLevel>(values.budgetLevel)));
+    } else {
+        hud.misc.visible = false;
+    }
+    if (hud.misc.visible) {
+        setWidgetText(hud.misc, hud.buffer);
+    }
+    setWidgetLayout(hud.misc, 32, 80, TEXT_ALIGN_LEFT);
+}
+
+// Brings the widgets in line with the snapshot, a no-op unless a bound value changed
+void updateHud(const FrameSnapshot& frame) {
+    PROFILE_ZONE("updateHud");
+    HudBindings values;
+    values.screen = frame.screen;
+    values.loading = !gameAssetsReady.load(std::memory_order_relaxed);
+    values.gameMode = frame.gameMode;
+    values.enemyEaten = frame.enemyEaten;
+    values.tokensEaten = frame.tokensEaten;
+    values.enemyCount = frame.enemyCount;
+    values.budgetLevel = frame.budgetLevel;
+
+    // The tokens layout measures a texture made with the font
+    if (!(values == hud.bound) || hud.fontReady != menuAssetsReady) {
+        layoutHud(values);
+        hud.bound = values;
+        hud.fontReady = menuAssetsReady;
+    }
+
+    // Labels follow the players, so their geometry moves with them
+    if (hud.labels.size() < frame.labels.size()) {
+        hud.labels.resize(frame.labels.size());
+    }
+    for (size_t i = 0; i < frame.labels.size(); i++) {
+        const SnapshotLabel& label = frame.labels[i];
+        snprintf(hud.buffer, sizeof(hud.buffer), "%d", label.number);
+        setWidgetText(hud.labels[i], hud.buffer);
+        setWidgetLayout(hud.labels[i], label.x, label.y, TEXT_ALIGN_LEFT);
+    }
+
+    if (profileCaptureActive() && (frameAllocations != hud.boundAllocations || frameTextureUploads != hud.boundUploads)) {
+        snprintf(hud.buffer, sizeof(hud.buffer), "Allocations: %llu  Texture uploads: %u", static_cast<unsigned long long>(frameAllocations), static_cast<unsigned>(frameTextureUploads));
+        setWidgetText(hud.frameWork, hud.buffer);
+        setWidgetLayout(hud.frameWork, 32, SCREEN_HEIGHT - 130, TEXT_ALIGN_LEFT);
+        hud.boundAllocations = frameAllocations;
+        hud.boundUploads = frameTextureUploads;
+    }
+}
+
+void renderMenu(const FrameSnapshot&, float) {
+    drawWidget(renderer, hud.gameName);
+    drawWidget(renderer, hud.navigation);
+    drawWidget(renderer, hud.loading);
+}
+
+// Playing and the end screen, which has no sprites in its snapshot
+void renderRound(const FrameSnapshot& frame, float alpha) {
+    // Draw players, enemies and tokens
+    renderSprites(frame, alpha);
+    flushSpriteBatch(renderer);
+
+    // Player numbers go on top of the batched sprites
+    for (size_t i = 0; i < frame.labels.size(); i++) {
+        drawWidget(renderer, hud.labels[i]);
+    }
+
+    drawWidget(renderer, hud.enemyEaten);
+    drawWidget(renderer, hud.tokensEaten);
+    drawWidget(renderer, hud.misc);
+}
+
+void renderPaused(const FrameSnapshot& frame, float alpha) {
+    renderRound(frame, alpha);
+    SDL_RenderCopy(renderer, pauseTexture, NULL, &pauseBounds);
+}
+
+const ScreenState screens[SCREEN_COUNT] = {
+    {enterMenu, nullptr, updateMenu, renderMenu},           // SCREEN_MENU
+    {enterPlaying, nullptr, updatePlaying, renderRound},    // SCREEN_PLAYING
+    {nullptr, nullptr, nullptr, renderPaused},              // SCREEN_PAUSED
+    {nullptr, nullptr, updateGameOver, renderRound}         // SCREEN_GAME_OVER
+};
+
+// Draws a snapshot published by the simulation, never the live game state.
+// alpha is how far we are between the snapshot's tick and the one before (0..1)
+void render(const FrameSnapshot& frame, float alpha) {
+    PROFILE_ZONE("render");
+    Uint64 renderStart = SDL_GetPerformanceCounter();
+    updateTextureCache(renderer, frame.tick); // upload and free textures around this snapshot
+    countFrameWork();
+    int backgroundColors = 255;
+    if (frame.screen != SCREEN_MENU && modeHasModifier(frame.gameMode, MOD_BLACK_END_SCREEN) && frame.enemyEaten >= maxEnemyEaten[frame.gameMode]) {
+        backgroundColors = 0;
+    }
+    SDL_SetRenderDrawColor(renderer, backgroundColors, backgroundColors, backgroundColors, 255); // white background
+    SDL_RenderClear(renderer);
+
+    updateHud(frame);
+    screens[frame.screen].render(frame, alpha);
+
+    // Frame times while profiling
+    if (profileCaptureActive()) {
+        drawProfileGraph(renderer, 32, SCREEN_HEIGHT - 82);
+        drawWidget(renderer, hud.frameWork);
+    }
+
+    reportRenderTime((SDL_GetPerformanceCounter() - renderStart) / static_cast<double>(SDL_GetPerformanceFrequency()));
+
     // Present everything on screen
+    PROFILE_ZONE("present");
     SDL_RenderPresent(renderer);
 }
 
 // ------------------ MAIN FUNCTION ------------------
 int main(int argc, char **argv) {
-    WHBProcInit();       // Initialize Wii U process system
-    romfsInit();         // Initialize ROM filesystem
-    chdir("romfs:/");    // Change working directory to ROM filesystem
-    WHBMountSdCard();
+    PlatformOptions options;
+    if (!platformInit(argc, argv, options)) { // Console services, romfs and SD card
+        return 1;
+    }
+    startJobSystem(options.jobWorkers);
+    if (options.profile) {
+        startProfileCapture();
+    }
 
     // Create SDL window and renderer
     window = SDL_CreateWindow("Nic Cage Eats Stuff", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
     renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    setTextureCacheRenderThread();
 
     if (startSDLSystems(window, renderer) > 0) { // Custom SDL initialization
         return 1;
@@ -962,65 +1524,157 @@ int main(int argc, char **argv) {
     // Controller always connected on this console
     refreshControllers();
 
-    srand(time(NULL));
-
-    // Load player sprite
-    playerSprite = loadSprite(renderer, "sprites/NicCageFace.png", SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+    // The seed and starting mode come from the replay when there is one
+    ReplayHeader replayHeader;
+    replayHeader.seed = static_cast<Uint32>(time(NULL));
+    replayHeader.startMode = static_cast<Sint16>(options.startMode);
+    if (options.replayPath != nullptr) {
+        isReplaying = startReplay(options.replayPath, replayHeader);
+        if (!isReplaying) {
+            return 1;
+        }
+    }
+    if (options.recordPath != nullptr) {
+        isRecording = startRecording(options.recordPath, replayHeader);
+    }
+    seedRandom(replayHeader.seed);
 
-    enemySprite = loadSprite(renderer, "sprites/celery.png", rng(0, SCREEN_WIDTH), rng(0, SCREEN_HEIGHT));
-    //addEnemy();
-    //addToken();
-    restartGame();
+    // Everything below reads its assets from the archive when there is one
+    bootStartCounter = SDL_GetPerformanceCounter();
+    if (!options.looseAssets) {
+        openAssetArchive(ARCHIVE_NAME);
+    }
 
-    // Load font
-    font = TTF_OpenFont("fonts/cour.ttf", 36);
+    // Decoding runs on loader threads while the window is already up
+    queueBootAssets();
+    startAssetLoader(2);
+
+    initSpatialGrid(enemyGrid, SCREEN_WIDTH, SCREEN_HEIGHT);
+    enemyHits.resize(rectBatchWords(STRESS_MAX_ENEMIES));
+    tokenHits.resize(rectBatchWords(MAX_TOKENS));
+    reserveEntities(enemies, STRESS_MAX_ENEMIES); // the largest limit of any mode
+    initFlowField(hunterField, SCREEN_WIDTH, SCREEN_HEIGHT);
+    reserveEntities(retiredEnemies, STRESS_MAX_ENEMIES);
+    reserveEntities(tokens, MAX_TOKENS);
+    reserveEntities(retiredTokens, MAX_TOKENS);
+    players.reserve(INPUT_SLOTS);
+    retiredPlayers.reserve(INPUT_SLOTS);
+
+    // Replays, recordings and --mode run game ticks from the first frame, so
+    // they wait for everything. Live play goes to the menu as soon as it can
+    // be drawn and the rest streams in.
+    bool waitForAllAssets = isReplaying || options.recordPath != nullptr || replayHeader.startMode >= 0;
+    while (isGameRunning && platformIsRunning() && !(waitForAllAssets ? bootAssetsDone : menuAssetsReady)) {
+        handleEvents();
+        finishBootAssets();
+        renderLoadingScreen();
+    }
+    if (waitForAllAssets && bootAssetsDone) {
+        initGame();
+    }
 
-    // Initialize tokenseaten and pause textures
-    updateTextureText(enemyEatenTexture, "Celery Eaten: 0/3", font, renderer, colors[3]);
-    updateTextureText(tokenseatenTexture, "Chicken Eaten: 0", font, renderer, colors[8]);
-    updateTextureText(pauseTexture, "GAME PAUSED. Press - to change game.", font, renderer, colors[8]);
+    // Host builds can jump straight into a game for profiling
+    size_t gameModeCount = sizeof(gameModeNames) / sizeof(gameModeNames[0]);
+    if (gameInitialized && replayHeader.startMode >= 0 && static_cast<size_t>(replayHeader.startMode) < gameModeCount) {
+        currentGameMode = replayHeader.startMode;
+        changeScreen(SCREEN_PLAYING);
+    }
+    int frameCount = 0;
+
+    const double counterFrequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    Uint32 statsLogTime = SDL_GetTicks();
+    std::vector<double> replayTickTimes;
+    Uint64 previousCounter = SDL_GetPerformanceCounter();
+    Uint64 replayStartCounter = previousCounter;
+
+    // Live play simulates on its own thread, replays tick in lockstep with the
+    // frames below so their timings measure one tick each
+    publishFrameSnapshot();
+    std::thread simulationThread;
+    if (!isReplaying) {
+        isSimulationRunning.store(true, std::memory_order_release);
+        simulationThread = std::thread(simulationLoop);
+    }
 
-    SDL_QueryTexture(pauseTexture, NULL, NULL, &pauseBounds.w, &pauseBounds.h);
-    pauseBounds.x = SCREEN_WIDTH / 2 - pauseBounds.w / 2;
-    pauseBounds.y = 200;
+    // ------------------ MAIN LOOP ------------------
+    while (isGameRunning && platformIsRunning()) {
+        handleEvents();          // Handle input events
 
-    // Load sound and music
-    sound = loadSound("sounds/pop1.wav");
-    music = loadMusic("music/background.ogg");
+        if (isReplaying) {
+            Uint64 currentCounter = SDL_GetPerformanceCounter();
+            if (frameCount > 0) {
+                replayTickTimes.push_back((currentCounter - previousCounter) / counterFrequency);
+            }
+            previousCounter = currentCounter;
 
-    Mix_PlayMusic(music, -1); // Play background music in loop
+            // Replays run one tick per frame as fast as possible
+            if (!simulateTick()) {
+                break;
+            }
+            render(latestSnapshot(), 1.0f);
+        } else {
+            SDL_GameController* controllers[INPUT_SLOTS] = {controller, controller1, controller2, controller3, controller4};
+            InputFrame liveFrame;
+            captureInput(liveFrame, controllers, pendingCommands);
+            publishLiveInput(liveFrame);
+            pendingCommands = 0;
+
+            finishBootAssets();
+
+            // Interpolate over the tick that follows the snapshot, a paused game holds still
+            const FrameSnapshot& frame = latestSnapshot();
+            double sincePublished = (SDL_GetPerformanceCounter() - frame.publishedAt) / counterFrequency;
+            float alpha = frame.screen == SCREEN_PAUSED ? 1.0f : static_cast<float>(SDL_min(sincePublished / SIM_TICK, 1.0));
+            render(frame, alpha); // Draw everything
+        }
 
-    // Timing variables
-    Uint32 previousFrameTime = SDL_GetTicks();
-    Uint32 currentFrameTime = previousFrameTime;
-    float deltaTime = 0.0f;
+        markProfileFrame();
+        frameCount++;
+        if (options.maxFrames > 0 && frameCount >= options.maxFrames) {
+            isGameRunning = false;
+        }
 
-    // ------------------ MAIN LOOP ------------------
-    while (isGameRunning && WHBProcIsRunning()) {
-        currentFrameTime = SDL_GetTicks();
-        deltaTime = (currentFrameTime - previousFrameTime) / 1000.0f; // Convert ms -> seconds
-        previousFrameTime = currentFrameTime;
+        if (SDL_GetTicks() - statsLogTime >= 60000) {
+            logSpriteBatchStats();
+            logFrameWorkStats();
+            statsLogTime = SDL_GetTicks();
+        }
+    }
 
-        handleEvents();          // Handle input events
+    if (simulationThread.joinable()) {
+        isSimulationRunning.store(false, std::memory_order_release);
+        simulationThread.join();
+    }
 
-        if (!isGamePaused) {     // Only update game logic if not paused
-            update(deltaTime);
+    if (isReplaying) {
+        double replaySeconds = (SDL_GetPerformanceCounter() - replayStartCounter) / counterFrequency;
+        printReplayTimings(replayTickTimes, replaySeconds);
+        if (ALLOCATION_COUNTING) {
+            printf("Enemy loop allocations: %llu\n", static_cast<unsigned long long>(enemyLoopAllocations));
         }
+        stopReplay();
+    }
+    stopRecording();
 
-        render();                // Draw everything
+    if (profileCaptureActive()) {
+        stopProfileCapture();
+        saveProfileTrace();
     }
 
     // ------------------ CLEANUP ------------------
+    stopAssetLoader();
+    stopJobSystem();
     Mix_FreeMusic(music);
     Mix_FreeChunk(sound);
-    SDL_DestroyTexture(playerSprite.texture);
+    clearTextureCache();
+    destroySpriteAtlas();
+    destroyGlyphAtlas();
     SDL_DestroyTexture(pauseTexture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     stopSDLSystems();
-    WHBUnmountSdCard();
-    romfsExit();
-    WHBProcShutdown();
+    closeAssetArchive(); // music and font read from it until here
+    platformShutdown();
 
     return 0; // Exit program
 }
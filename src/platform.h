@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stddef.h>
+
+// Everything that differs between the Wii U and the host build: process
+// lifetime, filesystem mounts and where the assets are read from.
+
+struct PlatformOptions {
+    bool headless = false;  // host only: dummy SDL video/audio drivers
+    int maxFrames = 0;      // host only: quit after this many frames, 0 runs forever
+    int startMode = -1;     // host only: skip the menu and start this game mode
+    const char *recordPath = nullptr;   // host only: record input to this replay log
+    const char *replayPath = nullptr;   // host only: play this replay log as fast as possible
+    bool profile = false;   // host only: capture profile zones from the start, saved on exit
+    int jobWorkers = -1;    // worker threads for the enemy update, -1 picks one per spare core
+    bool looseAssets = false; // host only: ignore assets.pak and read the loose files
+};
+
+// Call before any SDL init, leaves the working directory at the asset root
+bool platformInit(int argc, char **argv, PlatformOptions &options);
+
+bool platformIsRunning();
+
+// Directory the game may write to (traces, logs): the app's folder on the SD
+// card on Wii U, the directory the host build was started from
+const char *platformWritablePath();
+
+// A whole read-only file in memory: memory mapped on the host, read with one
+// bulk read on Wii U. nullptr when it cannot be opened.
+const void *platformMapFile(const char *path, size_t &size);
+
+void platformUnmapFile(const void *data, size_t size);
+
+void platformShutdown();
@@ -0,0 +1,139 @@
+#ifndef __WIIU__
+
+#include "platform.h"
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static char writablePath[1024] = ".";
+
+static void printUsage(const char *program)
+{
+    printf("Usage: %s [--romfs DIR] [--headless] [--frames N] [--mode N] [--record FILE | --replay FILE] [--jobs N] [--profile] [--loose-assets]\n", program);
+    printf("  --romfs DIR   read assets from DIR instead of ./romfs\n");
+    printf("  --headless    use SDL's dummy video and audio drivers\n");
+    printf("  --frames N    quit after N frames\n");
+    printf("  --mode N      skip the menu and start game mode N\n");
+    printf("  --record FILE record controller input to FILE\n");
+    printf("  --replay FILE replay FILE at full speed and print timings\n");
+    printf("  --jobs N      use N worker threads besides the main one, 0 runs single threaded\n");
+    printf("  --profile     capture profile zones and write nces-trace.json on exit\n");
+    printf("  --loose-assets read every asset from its own file, ignoring assets.pak\n");
+}
+
+bool platformInit(int argc, char **argv, PlatformOptions &options)
+{
+    const char *romfsPath = "romfs";
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--romfs") == 0 && hasValue)
+        {
+            romfsPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--headless") == 0)
+        {
+            options.headless = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+        {
+            options.maxFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--mode") == 0 && hasValue)
+        {
+            options.startMode = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--record") == 0 && hasValue)
+        {
+            options.recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && hasValue)
+        {
+            options.replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--profile") == 0)
+        {
+            options.profile = true;
+        }
+        else if (strcmp(argv[i], "--jobs") == 0 && hasValue)
+        {
+            options.jobWorkers = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--loose-assets") == 0)
+        {
+            options.looseAssets = true;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.headless)
+    {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    }
+
+    // Keep the launch directory for output, the working directory moves to the assets
+    if (getcwd(writablePath, sizeof(writablePath)) == nullptr)
+    {
+        strcpy(writablePath, ".");
+    }
+
+    // Asset paths are relative to the romfs root, same as on the console
+    if (chdir(romfsPath) != 0)
+    {
+        printf("Failed to open asset directory %s\n", romfsPath);
+        return false;
+    }
+
+    return true;
+}
+
+bool platformIsRunning()
+{
+    return true;
+}
+
+const char *platformWritablePath()
+{
+    return writablePath;
+}
+
+const void *platformMapFile(const char *path, size_t &size)
+{
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        size = static_cast<size_t>(info.st_size);
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file); // the mapping keeps its own reference
+    return data == MAP_FAILED ? nullptr : data;
+}
+
+void platformUnmapFile(const void *data, size_t size)
+{
+    munmap(const_cast<void *>(data), size);
+}
+
+void platformShutdown()
+{
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifdef __WIIU__
+
+#include "platform.h"
+#include <unistd.h>           // For chdir() to change directory
+#include <romfs-wiiu.h>       // Wii U ROM filesystem functions
+#include <whb/proc.h>         // Wii U process handling
+#include <whb/file.h>
+#include <whb/sdcard.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <malloc.h>
+
+static char writablePath[256] = "";
+
+bool platformInit(int, char **, PlatformOptions &options)
+{
+    WHBProcInit();       // Initialize Wii U process system
+    romfsInit();         // Initialize ROM filesystem
+    chdir("romfs:/");    // Change working directory to ROM filesystem
+    if (WHBMountSdCard())
+    {
+        snprintf(writablePath, sizeof(writablePath), "fs:%s/wiiu/apps/NicCageEatsStuff", WHBGetSdCardMountPath());
+        mkdir(writablePath, 0777); // fine if it already exists
+    }
+    options.jobWorkers = 2; // Espresso has three cores, the main thread takes one
+    return true;
+}
+
+bool platformIsRunning()
+{
+    return WHBProcIsRunning();
+}
+
+const char *platformWritablePath()
+{
+    return writablePath;
+}
+
+const void *platformMapFile(const char *path, size_t &size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return nullptr;
+    }
+
+    // romfs has no mmap, one big read is still far cheaper than a file per asset
+    void *data = nullptr;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        if (length > 0)
+        {
+            size = static_cast<size_t>(length);
+            data = memalign(64, size);
+            if (data != nullptr && fread(data, 1, size, file) != size)
+            {
+                free(data);
+                data = nullptr;
+            }
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+void platformUnmapFile(const void *data, size_t)
+{
+    free(const_cast<void *>(data));
+}
+
+void platformShutdown()
+{
+    WHBUnmountSdCard();
+    romfsExit();
+    WHBProcShutdown();
+}
+
+#endif
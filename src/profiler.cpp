@@ -0,0 +1,135 @@
+#include "profiler.h"
+#include <stdio.h>
+
+const Uint32 PROFILE_RING_SIZE = 1 << 15;   // power of two, ~1 MB of events
+const int PROFILE_GRAPH_FRAMES = 120;
+
+struct ProfileEvent {
+    const char *name;
+    Uint64 begin;
+    Uint64 end;
+    SDL_threadID thread;
+    std::atomic<Uint32> sequence;   // index + 1 once the event is fully written
+};
+
+std::atomic<bool> profilerCapturing(false);
+
+static ProfileEvent events[PROFILE_RING_SIZE];
+static std::atomic<Uint32> nextEvent(0);
+static Uint64 captureStart = 0;
+
+static float frameTimes[PROFILE_GRAPH_FRAMES] = {};
+static int nextFrameTime = 0;
+static Uint64 lastFrameMark = 0;
+
+void startProfileCapture()
+{
+    nextEvent.store(0, std::memory_order_relaxed);
+    for (auto &event : events)
+    {
+        event.sequence.store(0, std::memory_order_relaxed);
+    }
+    captureStart = SDL_GetPerformanceCounter();
+    profilerCapturing.store(true, std::memory_order_release);
+}
+
+void stopProfileCapture()
+{
+    profilerCapturing.store(false, std::memory_order_release);
+}
+
+void recordProfileZone(const char *name, Uint64 begin, Uint64 end)
+{
+    // Claiming a slot is the only shared write, the oldest events get overwritten
+    Uint32 index = nextEvent.fetch_add(1, std::memory_order_relaxed);
+    ProfileEvent &event = events[index & (PROFILE_RING_SIZE - 1)];
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // readers see the 0 before any new field
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    event.thread = SDL_ThreadID();
+    event.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool writeProfileTrace(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        printf("Failed to open trace file %s\n", path);
+        return false;
+    }
+
+    double microsecondsPerCount = 1000000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    Uint32 last = nextEvent.load(std::memory_order_acquire);
+    Uint32 first = last > PROFILE_RING_SIZE ? last - PROFILE_RING_SIZE : 0;
+    int written = 0;
+
+    fputs("{\"traceEvents\":[\n", file);
+    for (Uint32 index = first; index != last; index++)
+    {
+        const ProfileEvent &slot = events[index & (PROFILE_RING_SIZE - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+        {
+            continue; // being written or already overwritten
+        }
+        // Copy it out, then make sure no writer claimed the slot while copying
+        const char *name = slot.name;
+        Uint64 begin = slot.begin;
+        Uint64 end = slot.end;
+        SDL_threadID thread = slot.thread;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != index + 1 || begin < captureStart)
+        {
+            continue;
+        }
+        fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+                written > 0 ? ",\n" : "", name, static_cast<unsigned long>(thread),
+                (begin - captureStart) * microsecondsPerCount, (end - begin) * microsecondsPerCount);
+        written++;
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+    fclose(file);
+
+    printf("Wrote %d profile zones to %s\n", written, path);
+    return true;
+}
+
+void markProfileFrame()
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (lastFrameMark != 0)
+    {
+        frameTimes[nextFrameTime] = static_cast<float>((now - lastFrameMark) * 1000.0 / SDL_GetPerformanceFrequency());
+        nextFrameTime = (nextFrameTime + 1) % PROFILE_GRAPH_FRAMES;
+    }
+    lastFrameMark = now;
+}
+
+void drawProfileGraph(SDL_Renderer *renderer, int x, int y)
+{
+    const int graphHeight = 50; // ms
+    SDL_Rect bar;
+    for (int i = 0; i < PROFILE_GRAPH_FRAMES; i++)
+    {
+        float ms = frameTimes[(nextFrameTime + i) % PROFILE_GRAPH_FRAMES];
+        bar.h = SDL_min(static_cast<int>(ms), graphHeight);
+        bar.w = 2;
+        bar.x = x + i * 2;
+        bar.y = y + graphHeight - bar.h;
+        if (ms > 1000.0f / 60.0f)
+        {
+            SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+        }
+        else
+        {
+            SDL_SetRenderDrawColor(renderer, 0, 160, 0, 255);
+        }
+        SDL_RenderFillRect(renderer, &bar);
+    }
+
+    int budgetY = y + graphHeight - 17;
+    SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
+    SDL_RenderDrawLine(renderer, x, budgetY, x + PROFILE_GRAPH_FRAMES * 2, budgetY);
+}
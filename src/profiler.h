@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <atomic>
+
+// Scoped-zone profiler. PROFILE_ZONE("name") times the rest of the enclosing
+// block into a fixed ring of events shared by every thread, which can be
+// written out as Chrome trace_event JSON (chrome://tracing, Perfetto).
+// While capture is off a zone costs one relaxed load and a branch; building
+// with -DNCES_NO_PROFILER removes them completely.
+
+extern std::atomic<bool> profilerCapturing;
+
+void startProfileCapture();
+
+void stopProfileCapture();
+
+inline bool profileCaptureActive()
+{
+    return profilerCapturing.load(std::memory_order_relaxed);
+}
+
+void recordProfileZone(const char *name, Uint64 begin, Uint64 end);
+
+// Write the captured zones, oldest first. Returns false if the file can't be opened.
+bool writeProfileTrace(const char *path);
+
+// Frame-time history for the on-screen graph, call once per presented frame
+void markProfileFrame();
+
+// Last frames as bars, 1px per ms, with a line at the 60 Hz budget
+void drawProfileGraph(SDL_Renderer *renderer, int x, int y);
+
+struct ProfileZone {
+    const char *name;
+    Uint64 begin;
+
+    explicit ProfileZone(const char *zoneName) : name(zoneName), begin(profileCaptureActive() ? SDL_GetPerformanceCounter() : 0) {}
+
+    ~ProfileZone()
+    {
+        if (begin != 0)
+        {
+            recordProfileZone(name, begin, SDL_GetPerformanceCounter());
+        }
+    }
+};
+
+#ifdef NCES_NO_PROFILER
+#define PROFILE_ZONE(name) do {} while (0)
+#else
+#define PROFILE_ZONE_JOIN2(a, b) a##b
+#define PROFILE_ZONE_JOIN(a, b) PROFILE_ZONE_JOIN2(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_JOIN(profileZone, __LINE__)(name)
+#endif
@@ -0,0 +1,119 @@
+#include "random.h"
+
+struct RandomState {
+    Uint32 s[4];
+};
+
+static RandomState streams[RNG_STREAM_COUNT];
+
+static inline Uint32 rotl(Uint32 x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+static inline Uint32 next(RandomState &state)
+{
+    Uint32 *s = state.s;
+    const Uint32 result = rotl(s[1] * 5, 7) * 9;
+    const Uint32 t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 11);
+
+    return result;
+}
+
+// splitmix32, spreads one seed over the stream states
+static Uint32 splitmix32(Uint32 &x)
+{
+    Uint32 z = (x += 0x9e3779b9u);
+    z = (z ^ (z >> 16)) * 0x85ebca6bu;
+    z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+    return z ^ (z >> 16);
+}
+
+// Lemire's multiply-shift range reduction with rejection, no division in the common case
+static inline Uint32 nextBelow(RandomState &state, Uint32 range)
+{
+    Uint64 m = static_cast<Uint64>(next(state)) * range;
+    Uint32 low = static_cast<Uint32>(m);
+    if (low < range)
+    {
+        Uint32 threshold = (0u - range) % range;
+        while (low < threshold)
+        {
+            m = static_cast<Uint64>(next(state)) * range;
+            low = static_cast<Uint32>(m);
+        }
+    }
+    return static_cast<Uint32>(m >> 32);
+}
+
+static inline float nextUnit(RandomState &state)
+{
+    return (next(state) >> 8) * (1.0f / 16777216.0f); // 24 bits -> [0, 1)
+}
+
+void seedRandom(Uint32 seed)
+{
+    for (int stream = 0; stream < RNG_STREAM_COUNT; stream++)
+    {
+        Uint32 x = seed ^ (0x632be5abu * (stream + 1));
+        RandomState &state = streams[stream];
+        for (auto &word : state.s)
+        {
+            word = splitmix32(x);
+        }
+        if ((state.s[0] | state.s[1] | state.s[2] | state.s[3]) == 0)
+        {
+            state.s[0] = 1; // all-zero state would only ever return 0
+        }
+    }
+}
+
+int randomInt(RandomStream stream, int min, int max)
+{
+    Uint32 range = static_cast<Uint32>(max) - static_cast<Uint32>(min) + 1u; // unsigned, the span can exceed INT_MAX
+    if (range == 0)
+    {
+        return static_cast<int>(next(streams[stream])); // full 32 bit range
+    }
+    return static_cast<int>(static_cast<Uint32>(min) + nextBelow(streams[stream], range));
+}
+
+float randomFloat(RandomStream stream, float min, float max)
+{
+    return min + nextUnit(streams[stream]) * (max - min);
+}
+
+void randomFillInt(RandomStream stream, int *values, int count, int min, int max)
+{
+    RandomState &state = streams[stream];
+    Uint32 range = static_cast<Uint32>(max) - static_cast<Uint32>(min) + 1u;
+    if (range == 0)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            values[i] = static_cast<int>(next(state)); // full 32 bit range
+        }
+        return;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = static_cast<int>(static_cast<Uint32>(min) + nextBelow(state, range));
+    }
+}
+
+void randomFillFloat(RandomStream stream, float *values, int count, float min, float max)
+{
+    RandomState &state = streams[stream];
+    float scale = max - min;
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = min + nextUnit(state) * scale;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// Small seedable PRNG (xoshiro128**) with one independent stream per
+// subsystem, so e.g. random enemy sizes don't shift where things spawn.
+// Same seed gives the same game on the Wii U and the host build.
+
+enum RandomStream {
+    RNG_SPAWN = 0,   // new enemy/token positions and speeds
+    RNG_SIZE,        // randomSizeEnemies multipliers
+    RNG_RESPAWN,     // positions after being eaten
+    RNG_STREAM_COUNT
+};
+
+void seedRandom(Uint32 seed);
+
+// Uniform in [min, max], without modulo bias
+int randomInt(RandomStream stream, int min, int max);
+
+// Uniform in [min, max)
+float randomFloat(RandomStream stream, float min, float max);
+
+// Bulk versions for spawning many entities at once
+void randomFillInt(RandomStream stream, int *values, int count, int min, int max);
+
+void randomFillFloat(RandomStream stream, float *values, int count, float min, float max);
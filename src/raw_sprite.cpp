@@ -0,0 +1,153 @@
+#include "raw_sprite.h"
+#include "sprite_format.h"
+#include "asset_archive.h"
+#include "profiler.h"
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+
+std::string rawSpritePath(const std::string &pngPath)
+{
+    size_t dot = pngPath.find_last_of('.');
+    size_t slash = pngPath.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        return pngPath + RAW_SPRITE_EXTENSION;
+    }
+    return pngPath.substr(0, dot) + RAW_SPRITE_EXTENSION;
+}
+
+static SDL_Surface *loadRawSprite(SDL_RWops *src, const char *path, SpritePixels &pixels)
+{
+    RawSpriteHeader header;
+    if (SDL_RWread(src, &header, sizeof(header), 1) != 1 || memcmp(header.magic, RAW_SPRITE_MAGIC, sizeof(RAW_SPRITE_MAGIC)) != 0 || SDL_SwapLE32(header.version) != RAW_SPRITE_VERSION)
+    {
+        printf("Pre-decoded sprite %s is not a version %u sprite\n", path, static_cast<unsigned>(RAW_SPRITE_VERSION));
+        return nullptr;
+    }
+
+    // Check the header against the file before trusting it with an allocation
+    Uint32 width = SDL_SwapLE32(header.width);
+    Uint32 height = SDL_SwapLE32(header.height);
+    Uint32 drawWidth = SDL_SwapLE32(header.drawWidth);
+    Uint32 drawHeight = SDL_SwapLE32(header.drawHeight);
+    if (width == 0 || height == 0 || width > RAW_SPRITE_MAX_SIZE || height > RAW_SPRITE_MAX_SIZE ||
+        drawWidth == 0 || drawHeight == 0 || drawWidth > RAW_SPRITE_MAX_SIZE || drawHeight > RAW_SPRITE_MAX_SIZE)
+    {
+        printf("Pre-decoded sprite %s has a bad size of %ux%u\n", path, static_cast<unsigned>(width), static_cast<unsigned>(height));
+        return nullptr;
+    }
+    Sint64 expected = static_cast<Sint64>(width) * height * 4 + static_cast<Sint64>(sizeof(header));
+    Sint64 length = SDL_RWsize(src);
+    if (length >= 0 && length < expected)
+    {
+        printf("Pre-decoded sprite %s is truncated\n", path);
+        return nullptr;
+    }
+
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, static_cast<int>(width), static_cast<int>(height), 32, SDL_PIXELFORMAT_RGBA32);
+    if (surface == nullptr)
+    {
+        return nullptr;
+    }
+
+    // Rows are stored tightly packed, the surface may pad them
+    Uint8 *row = static_cast<Uint8 *>(surface->pixels);
+    for (Uint32 y = 0; y < height; y++, row += surface->pitch)
+    {
+        if (SDL_RWread(src, row, static_cast<size_t>(width) * 4, 1) != 1)
+        {
+            printf("Pre-decoded sprite %s is truncated\n", path);
+            SDL_FreeSurface(surface);
+            return nullptr;
+        }
+    }
+
+    pixels.drawWidth = static_cast<int>(drawWidth);
+    pixels.drawHeight = static_cast<int>(drawHeight);
+    return surface;
+}
+
+bool loadSpritePixels(const char *pngPath, SpritePixels &pixels)
+{
+    std::string rawPath = rawSpritePath(pngPath);
+    if (assetExists(rawPath.c_str()))
+    {
+        PROFILE_ZONE("loadRawSprite");
+        SDL_RWops *src = openAsset(rawPath.c_str());
+        pixels.surface = src != nullptr ? loadRawSprite(src, rawPath.c_str(), pixels) : nullptr;
+        if (src != nullptr)
+        {
+            SDL_RWclose(src);
+        }
+        if (pixels.surface != nullptr)
+        {
+            pixels.preDecoded = true;
+            return true;
+        }
+    }
+
+    PROFILE_ZONE("decodePng");
+    SDL_Surface *loaded = IMG_Load_RW(openAsset(pngPath), 1);
+    if (loaded == nullptr)
+    {
+        printf("Failed to load sprite %s! SDL_image Error: %s\n", pngPath, IMG_GetError());
+        return false;
+    }
+    pixels.surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (pixels.surface == nullptr)
+    {
+        return false;
+    }
+    SDL_PremultiplyAlpha(pixels.surface->w, pixels.surface->h, SDL_PIXELFORMAT_RGBA32, pixels.surface->pixels, pixels.surface->pitch,
+                         SDL_PIXELFORMAT_RGBA32, pixels.surface->pixels, pixels.surface->pitch);
+    pixels.drawWidth = pixels.surface->w;
+    pixels.drawHeight = pixels.surface->h;
+    pixels.preDecoded = false;
+    return true;
+}
+
+static void unpremultiply(SDL_Surface *surface)
+{
+    Uint8 *row = static_cast<Uint8 *>(surface->pixels);
+    for (int y = 0; y < surface->h; y++, row += surface->pitch)
+    {
+        for (Uint8 *pixel = row; pixel < row + surface->w * 4; pixel += 4)
+        {
+            Uint8 alpha = pixel[3];
+            if (alpha != 0 && alpha != 255)
+            {
+                pixel[0] = static_cast<Uint8>(SDL_min(255, pixel[0] * 255 / alpha));
+                pixel[1] = static_cast<Uint8>(SDL_min(255, pixel[1] * 255 / alpha));
+                pixel[2] = static_cast<Uint8>(SDL_min(255, pixel[2] * 255 / alpha));
+            }
+        }
+    }
+}
+
+SDL_Texture *createSpriteTexture(SDL_Renderer *renderer, SDL_Surface *surface)
+{
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, surface->w, surface->h);
+    if (texture == nullptr)
+    {
+        return nullptr;
+    }
+
+    static const SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+    if (SDL_SetTextureBlendMode(texture, premultiplied) != 0)
+    {
+        unpremultiply(surface);
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+
+    if (SDL_UpdateTexture(texture, nullptr, surface->pixels, surface->pitch) != 0)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Unable to upload sprite texture! SDL Error: %s\n", SDL_GetError());
+        SDL_DestroyTexture(texture);
+        return nullptr;
+    }
+    return texture;
+}
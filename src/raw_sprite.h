@@ -0,0 +1,26 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+
+// Sprite pixels for upload, always RGBA32 with premultiplied alpha. Comes
+// from the pre-decoded .rgba next to the PNG when there is one, which skips
+// PNG decoding entirely, and from the PNG otherwise.
+
+struct SpritePixels {
+    SDL_Surface *surface = nullptr;
+    int drawWidth = 0;      // size to draw at, can be larger than the surface
+    int drawHeight = 0;
+    bool preDecoded = false;
+};
+
+// "sprites/celery.png" -> "sprites/celery.rgba"
+std::string rawSpritePath(const std::string &pngPath);
+
+// False when neither version loads. Free pixels.surface when done.
+bool loadSpritePixels(const char *pngPath, SpritePixels &pixels);
+
+// Static texture with premultiplied blending, pixels uploaded straight from
+// surface. Renderers without custom blend modes get the pixels converted back
+// to straight alpha and normal blending instead.
+SDL_Texture *createSpriteTexture(SDL_Renderer *renderer, SDL_Surface *surface);
@@ -0,0 +1,65 @@
+#include "rect_batch.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// a and b overlap when each one starts before the other ends, strictly, as in SDL
+static inline Uint32 rectHit(int left, int top, int right, int bottom, int x, int y, int w, int h)
+{
+    return (w > 0) & (h > 0) & (left < x + w) & (x < right) & (top < y + h) & (y < bottom);
+}
+
+int intersectRectBatch(const SDL_Rect &rect, const int *x, const int *y, const int *w, const int *h, int count, Uint32 *hits)
+{
+    for (int word = 0; word < rectBatchWords(count); word++)
+    {
+        hits[word] = 0;
+    }
+    if (rect.w <= 0 || rect.h <= 0)
+    {
+        return 0;
+    }
+
+    const int left = rect.x;
+    const int top = rect.y;
+    const int right = rect.x + rect.w;
+    const int bottom = rect.y + rect.h;
+    int hitCount = 0;
+    int i = 0;
+
+#if defined(__SSE2__)
+    // Four rects per step. SSE2 only has a signed greater-than, so every
+    // test is written as one.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i leftV = _mm_set1_epi32(left);
+    const __m128i topV = _mm_set1_epi32(top);
+    const __m128i rightV = _mm_set1_epi32(right);
+    const __m128i bottomV = _mm_set1_epi32(bottom);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i xs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i));
+        __m128i ys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i));
+        __m128i ws = _mm_loadu_si128(reinterpret_cast<const __m128i *>(w + i));
+        __m128i hs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i));
+        __m128i hit = _mm_and_si128(_mm_cmpgt_epi32(ws, zero), _mm_cmpgt_epi32(hs, zero));
+        hit = _mm_and_si128(hit, _mm_cmpgt_epi32(_mm_add_epi32(xs, ws), leftV));
+        hit = _mm_and_si128(hit, _mm_cmpgt_epi32(rightV, xs));
+        hit = _mm_and_si128(hit, _mm_cmpgt_epi32(_mm_add_epi32(ys, hs), topV));
+        hit = _mm_and_si128(hit, _mm_cmpgt_epi32(bottomV, ys));
+        Uint32 lanes = static_cast<Uint32>(_mm_movemask_ps(_mm_castsi128_ps(hit)));
+        hits[i / 32] |= lanes << (i % 32);
+        hitCount += __builtin_popcount(lanes);
+    }
+#endif
+
+    // Remainder, and everything on targets without SSE2. Branchless so the
+    // compiler can still vectorise it where it knows how.
+    for (; i < count; i++)
+    {
+        Uint32 hit = rectHit(left, top, right, bottom, x[i], y[i], w[i], h[i]);
+        hits[i / 32] |= hit << (i % 32);
+        hitCount += hit;
+    }
+    return hitCount;
+}
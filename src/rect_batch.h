@@ -0,0 +1,31 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// One rect against many, for the mouth-vs-entity tests. The others come as
+// parallel x/y/w/h arrays (the EntityStore columns) and the result is a bit
+// mask, bit i of hits[i / 32] set when rect i overlaps. Matches
+// SDL_HasIntersection exactly, empty rects never hit.
+
+inline int rectBatchWords(int count)
+{
+    return (count + 31) / 32;
+}
+
+// hits needs rectBatchWords(count) words. Returns the number of hits.
+int intersectRectBatch(const SDL_Rect &rect, const int *x, const int *y, const int *w, const int *h, int count, Uint32 *hits);
+
+// Calls fn(index) for every set bit, lowest index first
+template <typename Fn>
+void forEachHit(const Uint32 *hits, int count, Fn fn)
+{
+    for (int word = 0; word < rectBatchWords(count); word++)
+    {
+        Uint32 bits = hits[word];
+        while (bits != 0)
+        {
+            fn(word * 32 + __builtin_ctz(bits));
+            bits &= bits - 1;
+        }
+    }
+}
@@ -0,0 +1,201 @@
+#include "replay.h"
+#include <algorithm>
+
+static const Uint32 REPLAY_MAGIC = 0x5052434e; // "NCRP"
+// Bumped whenever the same input plays out differently, old replays would diverge.
+// 2: orbits step by a fixed rotation
+// 3: screen state machine, pause is ignored on the menu and restarts happen before the update
+static const Uint16 REPLAY_VERSION = 3;
+
+struct ReplayFile {
+    SDL_RWops *file = nullptr;
+    InputFrame frame;     // frame of the current run
+    Uint32 remaining = 0; // recording: ticks in the current run, playback: ticks left in it
+};
+
+static ReplayFile recording;
+static ReplayFile playback;
+
+// Fields are written one by one in little endian so logs move between the
+// console and the host build
+static void writeFrame(SDL_RWops *file, const InputFrame &frame)
+{
+    SDL_WriteU8(file, frame.commands);
+    for (const InputSlot &slot : frame.slots)
+    {
+        SDL_WriteLE16(file, slot.buttons);
+        SDL_WriteLE16(file, static_cast<Uint16>(slot.leftX));
+        SDL_WriteLE16(file, static_cast<Uint16>(slot.leftY));
+        SDL_WriteU8(file, static_cast<Uint8>(slot.playerIndex));
+        SDL_WriteU8(file, slot.attached);
+    }
+}
+
+static bool readFrame(SDL_RWops *file, InputFrame &frame)
+{
+    Uint8 bytes[1 + INPUT_SLOTS * 8];
+    if (SDL_RWread(file, bytes, sizeof(bytes), 1) != 1)
+    {
+        return false;
+    }
+
+    frame.commands = bytes[0];
+    const Uint8 *cursor = bytes + 1;
+    for (InputSlot &slot : frame.slots)
+    {
+        slot.buttons = static_cast<Uint16>(cursor[0] | (cursor[1] << 8));
+        slot.leftX = static_cast<Sint16>(cursor[2] | (cursor[3] << 8));
+        slot.leftY = static_cast<Sint16>(cursor[4] | (cursor[5] << 8));
+        slot.playerIndex = static_cast<Sint8>(cursor[6]);
+        slot.attached = cursor[7];
+        cursor += 8;
+    }
+    return true;
+}
+
+static void flushRun()
+{
+    if (recording.remaining == 0)
+    {
+        return;
+    }
+    SDL_WriteLE16(recording.file, static_cast<Uint16>(recording.remaining));
+    writeFrame(recording.file, recording.frame);
+    recording.remaining = 0;
+}
+
+bool startRecording(const char *filePath, const ReplayHeader &header)
+{
+    stopRecording();
+
+    recording.file = SDL_RWFromFile(filePath, "wb");
+    if (recording.file == nullptr)
+    {
+        printf("Failed to create replay %s! SDL Error: %s\n", filePath, SDL_GetError());
+        return false;
+    }
+
+    SDL_WriteLE32(recording.file, REPLAY_MAGIC);
+    SDL_WriteLE16(recording.file, REPLAY_VERSION);
+    SDL_WriteLE16(recording.file, static_cast<Uint16>(header.startMode));
+    SDL_WriteLE32(recording.file, header.seed);
+    recording.remaining = 0;
+    return true;
+}
+
+void recordInput(const InputFrame &frame)
+{
+    if (recording.file == nullptr)
+    {
+        return;
+    }
+
+    if (recording.remaining > 0 && recording.remaining < 0xffff && sameInput(frame, recording.frame))
+    {
+        recording.remaining++;
+        return;
+    }
+
+    flushRun();
+    recording.frame = frame;
+    recording.remaining = 1;
+}
+
+void stopRecording()
+{
+    if (recording.file == nullptr)
+    {
+        return;
+    }
+    flushRun();
+    SDL_RWclose(recording.file);
+    recording.file = nullptr;
+}
+
+bool startReplay(const char *filePath, ReplayHeader &header)
+{
+    stopReplay();
+
+    playback.file = SDL_RWFromFile(filePath, "rb");
+    if (playback.file == nullptr)
+    {
+        printf("Failed to open replay %s! SDL Error: %s\n", filePath, SDL_GetError());
+        return false;
+    }
+
+    Uint32 magic = SDL_ReadLE32(playback.file);
+    Uint16 version = SDL_ReadLE16(playback.file);
+    if (magic != REPLAY_MAGIC || version != REPLAY_VERSION)
+    {
+        printf("%s is not a replay this build can play\n", filePath);
+        stopReplay();
+        return false;
+    }
+
+    header.startMode = static_cast<Sint16>(SDL_ReadLE16(playback.file));
+    header.seed = SDL_ReadLE32(playback.file);
+    playback.remaining = 0;
+    return true;
+}
+
+bool nextReplayInput(InputFrame &frame)
+{
+    if (playback.file == nullptr)
+    {
+        return false;
+    }
+
+    if (playback.remaining == 0)
+    {
+        Uint16 runLength = 0;
+        if (SDL_RWread(playback.file, &runLength, sizeof(runLength), 1) != 1 || !readFrame(playback.file, playback.frame))
+        {
+            return false;
+        }
+        playback.remaining = SDL_SwapLE16(runLength);
+
+        // The recorder never writes an empty run, so the log is corrupt
+        if (playback.remaining == 0)
+        {
+            printf("Replay has a zero-length run, stopping playback\n");
+            stopReplay();
+            return false;
+        }
+    }
+
+    playback.remaining--;
+    frame = playback.frame;
+    return true;
+}
+
+void stopReplay()
+{
+    if (playback.file != nullptr)
+    {
+        SDL_RWclose(playback.file);
+        playback.file = nullptr;
+    }
+}
+
+static double percentile(const std::vector<double> &sorted, double fraction)
+{
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+void printReplayTimings(std::vector<double> &tickSeconds, double totalSeconds)
+{
+    if (tickSeconds.empty() || totalSeconds <= 0.0)
+    {
+        printf("Replay: no ticks ran\n");
+        return;
+    }
+
+    std::sort(tickSeconds.begin(), tickSeconds.end());
+    printf("Replay: %zu ticks in %.3f s, %.1f ticks/s\n", tickSeconds.size(), totalSeconds, tickSeconds.size() / totalSeconds);
+    printf("Frame time ms: p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+        percentile(tickSeconds, 0.50) * 1000.0,
+        percentile(tickSeconds, 0.90) * 1000.0,
+        percentile(tickSeconds, 0.99) * 1000.0,
+        tickSeconds.back() * 1000.0);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "input.h"
+#include <vector>
+
+// Input recording and playback.
+// A log holds the RNG seed and start mode followed by one InputFrame per
+// simulation tick, run-length encoded since input rarely changes tick to tick.
+
+struct ReplayHeader {
+    Uint32 seed = 0;
+    Sint16 startMode = -1;  // game mode the run started in, -1 for the menu
+};
+
+bool startRecording(const char *filePath, const ReplayHeader &header);
+
+void recordInput(const InputFrame &frame);
+
+void stopRecording();
+
+bool startReplay(const char *filePath, ReplayHeader &header);
+
+// Next tick's input, false once the log runs out
+bool nextReplayInput(InputFrame &frame);
+
+void stopReplay();
+
+// Print ticks per second and frame time percentiles for a replay run
+void printReplayTimings(std::vector<double> &tickSeconds, double totalSeconds);
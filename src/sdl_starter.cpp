@@ -1,4 +1,7 @@
 #include "sdl_starter.h"
+#include "texture_cache.h"
+#include "profiler.h"
+#include "asset_archive.h"
 #include <cmath>
 
 int startSDLSystems(SDL_Window *window, SDL_Renderer *renderer)
@@ -49,20 +52,45 @@ int startSDLSystems(SDL_Window *window, SDL_Renderer *renderer)
 Sprite loadSprite(SDL_Renderer* renderer, const char* filePath, int positionX, int positionY, float vx, float vy) {
     SDL_Rect bounds = {positionX, positionY, 0, 0};
 
-    SDL_Texture* texture = IMG_LoadTexture(renderer, filePath);
+    const SpriteImage* image = acquireImage(renderer, filePath);
 
-    if (texture != nullptr)
+    if (image != nullptr)
     {
-        SDL_QueryTexture(texture, nullptr, nullptr, &bounds.w, &bounds.h);
+        bounds.w = image->width;
+        bounds.h = image->height;
     }
 
-    Sprite sprite = {texture, bounds, vx, vy, positionX, positionY, NAN, false, false, false, false, 0, nullptr, -1, false}; // vx, vy default to 0 if not passed
+    Sprite sprite = {image, bounds, vx, vy, positionX, positionY, NAN, static_cast<float>(positionX), static_cast<float>(positionY), false, false, false, false, 0, -1, false}; // vx, vy default to 0 if not passed
+    sprite.variants[SPRITE_STATE_NORMAL] = image;
     return sprite;
 }
 
+void releaseSprite(Sprite &sprite) {
+    for (auto& variant : sprite.variants) {
+        releaseImage(variant);
+        variant = nullptr;
+    }
+    sprite.image = nullptr;
+}
+
+void loadSpriteVariant(SDL_Renderer* renderer, Sprite &sprite, SpriteState state, const char* filePath) {
+    const SpriteImage* image = acquireImage(renderer, filePath);
+    releaseImage(sprite.variants[state]);
+    sprite.variants[state] = image;
+    if (sprite.state == state) {
+        sprite.image = image;
+    }
+}
+
+void setSpriteState(Sprite &sprite, SpriteState state) {
+    sprite.state = state;
+    sprite.image = sprite.variants[state] != nullptr ? sprite.variants[state] : sprite.variants[SPRITE_STATE_NORMAL];
+}
+
 Mix_Chunk *loadSound(const char *filePath)
 {
-    Mix_Chunk *sound = Mix_LoadWAV(filePath);
+    PROFILE_ZONE("loadSound");
+    Mix_Chunk *sound = Mix_LoadWAV_RW(openAsset(filePath), 1);
     if (sound == nullptr)
     {
         printf("Failed to load scratch sound effect! SDL_mixer Error: %s\n", Mix_GetError());
@@ -73,7 +101,8 @@ Mix_Chunk *loadSound(const char *filePath)
 
 Mix_Music *loadMusic(const char *filePath)
 {
-    Mix_Music *music = Mix_LoadMUS(filePath);
+    PROFILE_ZONE("loadMusic");
+    Mix_Music *music = Mix_LoadMUS_RW(openAsset(filePath), 1);
     if (music == nullptr)
     {
         printf("Failed to load music! SDL_mixer Error: %s\n", Mix_GetError());
@@ -28,28 +28,67 @@
 const int SCREEN_WIDTH = 1920;
 const int SCREEN_HEIGHT = 1080;
 
+// Fixed simulation rate, render() interpolates between the last two ticks
+const int SIM_TICKS_PER_SECOND = 60;
+const float SIM_TICK = 1.0f / SIM_TICKS_PER_SECOND;
+
+// Moving further than this in one tick is a respawn or wrap, not motion
+const float TELEPORT_DISTANCE = 256.0f;
+
+inline float interpolatePosition(float previous, float current, float alpha)
+{
+    float delta = current - previous;
+    if (delta > TELEPORT_DISTANCE || delta < -TELEPORT_DISTANCE) {
+        return current;
+    }
+    return previous + delta * alpha;
+}
+
+// Alternate looks a sprite can switch between without loading anything
+enum SpriteState {
+    SPRITE_STATE_NORMAL = 0,
+    SPRITE_STATE_INVULNERABLE,
+    SPRITE_STATE_ANGRY,
+    SPRITE_STATE_COUNT
+};
+
+struct SpriteImage;
+
 struct Sprite {
-    SDL_Texture *texture;
+    const SpriteImage *image;   // cached image, possibly a region of the sprite atlas
     SDL_Rect bounds;
     float hv = 0.0f;
     float vv = 0.0f;
     float fx = 0.0f;
     float fy = 0.0f;
     float angle;
+    float prevFx = 0.0f; // position at the previous tick, for render interpolation
+    float prevFy = 0.0f;
     bool protectingToken = false;
     bool invulnerable = false;
     bool immobile = false;
     bool evil = false;
     int evilTimer = 0;
-    SDL_GameController* controller = nullptr;
     int controllerId = -1;
     bool previousInvulnerable = false;
+    SpriteState state = SPRITE_STATE_NORMAL;
+    const SpriteImage *variants[SPRITE_STATE_COUNT] = {}; // preloaded images per state, image points at one of these
+    SDL_Rect mouth = {}; // players only, the part that eats
 };
 
 int startSDLSystems(SDL_Window *window, SDL_Renderer *renderer);
 
+// Sprites share their image through the texture cache, pair with releaseSprite()
 Sprite loadSprite(SDL_Renderer* renderer, const char* filePath, int positionX, int positionY, float vx = 0.0f, float vy = 0.0f);
 
+void releaseSprite(Sprite &sprite);
+
+// Preload the image shown while the sprite is in the given state
+void loadSpriteVariant(SDL_Renderer* renderer, Sprite &sprite, SpriteState state, const char* filePath);
+
+// Switch to a preloaded state, states without a variant fall back to normal
+void setSpriteState(Sprite &sprite, SpriteState state);
+
 Mix_Chunk *loadSound(const char *filePath);
 
 Mix_Music *loadMusic(const char *filePath);
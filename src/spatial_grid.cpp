@@ -0,0 +1,155 @@
+#include "spatial_grid.h"
+#include <algorithm>
+
+static GridCellRange cellRangeFor(const SpatialGrid &grid, const SDL_Rect &rect)
+{
+    GridCellRange range;
+    range.x0 = SDL_max(0, SDL_min(grid.columns - 1, rect.x / GRID_CELL_SIZE));
+    range.y0 = SDL_max(0, SDL_min(grid.rows - 1, rect.y / GRID_CELL_SIZE));
+    range.x1 = SDL_max(0, SDL_min(grid.columns - 1, (rect.x + rect.w) / GRID_CELL_SIZE));
+    range.y1 = SDL_max(0, SDL_min(grid.rows - 1, (rect.y + rect.h) / GRID_CELL_SIZE));
+    return range;
+}
+
+static void removeFromCells(SpatialGrid &grid, int index, const GridCellRange &range)
+{
+    for (int y = range.y0; y <= range.y1; y++)
+    {
+        for (int x = range.x0; x <= range.x1; x++)
+        {
+            std::vector<int> &cell = grid.cells[y * grid.columns + x];
+            auto found = std::find(cell.begin(), cell.end(), index);
+            if (found != cell.end())
+            {
+                *found = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+}
+
+void initSpatialGrid(SpatialGrid &grid, int width, int height)
+{
+    grid.columns = (width + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+    grid.rows = (height + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+    grid.cells.assign(grid.columns * grid.rows, std::vector<int>());
+    grid.itemCells.clear();
+    grid.itemStamps.clear();
+    grid.queryStamp = 0;
+}
+
+void resetSpatialGrid(SpatialGrid &grid)
+{
+    for (auto &cell : grid.cells)
+    {
+        cell.clear();
+    }
+    grid.itemCells.clear();
+    grid.itemStamps.clear();
+}
+
+void updateSpatialGridItem(SpatialGrid &grid, int index, const SDL_Rect &bounds)
+{
+    if (index >= static_cast<int>(grid.itemCells.size()))
+    {
+        grid.itemCells.resize(index + 1, GridCellRange{-1, -1, -1, -1});
+        grid.itemStamps.resize(index + 1, 0);
+    }
+
+    GridCellRange range = cellRangeFor(grid, bounds);
+    GridCellRange &current = grid.itemCells[index];
+    if (current.x0 == range.x0 && current.y0 == range.y0 && current.x1 == range.x1 && current.y1 == range.y1)
+    {
+        return; // still in the same cells, nothing to do
+    }
+
+    if (current.x0 >= 0)
+    {
+        removeFromCells(grid, index, current);
+    }
+
+    for (int y = range.y0; y <= range.y1; y++)
+    {
+        for (int x = range.x0; x <= range.x1; x++)
+        {
+            grid.cells[y * grid.columns + x].push_back(index);
+        }
+    }
+    current = range;
+}
+
+void truncateSpatialGrid(SpatialGrid &grid, int count)
+{
+    for (int index = count; index < static_cast<int>(grid.itemCells.size()); index++)
+    {
+        if (grid.itemCells[index].x0 >= 0)
+        {
+            removeFromCells(grid, index, grid.itemCells[index]);
+        }
+    }
+    if (count < static_cast<int>(grid.itemCells.size()))
+    {
+        grid.itemCells.resize(count);
+        grid.itemStamps.resize(count);
+    }
+}
+
+void querySpatialGrid(SpatialGrid &grid, const SDL_Rect &rect, std::vector<int> &results)
+{
+    results.clear();
+
+    if (++grid.queryStamp == 0)
+    {
+        // Stamp wrapped around, forget the old ones
+        std::fill(grid.itemStamps.begin(), grid.itemStamps.end(), 0);
+        grid.queryStamp = 1;
+    }
+
+    GridCellRange range = cellRangeFor(grid, rect);
+    for (int y = range.y0; y <= range.y1; y++)
+    {
+        for (int x = range.x0; x <= range.x1; x++)
+        {
+            for (int index : grid.cells[y * grid.columns + x])
+            {
+                if (grid.itemStamps[index] != grid.queryStamp)
+                {
+                    grid.itemStamps[index] = grid.queryStamp;
+                    results.push_back(index);
+                }
+            }
+        }
+    }
+
+    // Same order as walking the entity list so gameplay stays deterministic
+    std::sort(results.begin(), results.end());
+}
+
+void querySpatialGridShared(const SpatialGrid &grid, const SDL_Rect &rect, std::vector<int> &results)
+{
+    results.clear();
+
+    GridCellRange range = cellRangeFor(grid, rect);
+    for (int y = range.y0; y <= range.y1; y++)
+    {
+        for (int x = range.x0; x <= range.x1; x++)
+        {
+            const std::vector<int> &cell = grid.cells[y * grid.columns + x];
+            results.insert(results.end(), cell.begin(), cell.end());
+        }
+    }
+
+    // Items spanning several cells show up once per cell
+    std::sort(results.begin(), results.end());
+    results.erase(std::unique(results.begin(), results.end()), results.end());
+}
+
+int spatialGridMaxCellItems(const SpatialGrid &grid)
+{
+    size_t most = 0;
+    for (const auto &cell : grid.cells)
+    {
+        most = std::max(most, cell.size());
+    }
+    return static_cast<int>(most);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+// Uniform grid broadphase over the playfield.
+// Items are identified by their index (enemies[i], tokens[i], ...) and only
+// move between cells when their bounds cross a cell edge, so keeping the grid
+// up to date each tick is cheap.
+
+const int GRID_CELL_SIZE = 128;
+
+struct GridCellRange {
+    int x0, y0, x1, y1;
+};
+
+struct SpatialGrid {
+    int columns = 0;
+    int rows = 0;
+    std::vector<std::vector<int>> cells;
+    std::vector<GridCellRange> itemCells;   // cells each item is stored in, x0 < 0 when not stored
+    std::vector<unsigned> itemStamps;       // deduplicates items spanning several cells during a query
+    unsigned queryStamp = 0;
+};
+
+void initSpatialGrid(SpatialGrid &grid, int width, int height);
+
+// Remove every item, keeps the allocated cells around
+void resetSpatialGrid(SpatialGrid &grid);
+
+// Insert or move an item
+void updateSpatialGridItem(SpatialGrid &grid, int index, const SDL_Rect &bounds);
+
+// Drop items with an index >= count
+void truncateSpatialGrid(SpatialGrid &grid, int count);
+
+// Collect the indices of items whose cells overlap rect, sorted ascending.
+// Callers still do the exact intersection test.
+void querySpatialGrid(SpatialGrid &grid, const SDL_Rect &rect, std::vector<int> &results);
+
+// Same results without touching the grid's stamps, so several threads can
+// query at once as long as nobody updates the grid meanwhile
+void querySpatialGridShared(const SpatialGrid &grid, const SDL_Rect &rect, std::vector<int> &results);
+
+// Most items stored in any one cell, bounds what a query can return
+int spatialGridMaxCellItems(const SpatialGrid &grid);
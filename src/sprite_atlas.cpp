@@ -0,0 +1,292 @@
+#include "sprite_atlas.h"
+#include "texture_cache.h"
+#include "profiler.h"
+#include "asset_archive.h"
+#include "raw_sprite.h"
+#include "sprite_format.h"
+#include <algorithm>
+#include <string.h>
+#include <string>
+#include <vector>
+
+const int ATLAS_MAX_SIZE = 2048;
+const int ATLAS_PADDING = 1; // keeps filtered edges from sampling the neighbour
+
+struct PackedSprite {
+    std::string path;
+    SDL_Surface *surface = nullptr;
+    SDL_Rect rect = {};
+    int drawWidth = 0;
+    int drawHeight = 0;
+    bool placed = false;
+};
+
+struct AtlasPage {
+    SDL_Texture *texture;
+    int width, height;
+};
+
+static std::vector<AtlasPage> atlasPages;
+
+static bool hasExtension(const std::string &name, const char *extension)
+{
+    size_t length = strlen(extension);
+    return name.size() > length && name.compare(name.size() - length, length, extension) == 0;
+}
+
+static void freeSurfaces(std::vector<PackedSprite> &sprites)
+{
+    for (auto &sprite : sprites)
+    {
+        SDL_FreeSurface(sprite.surface);
+        sprite.surface = nullptr;
+    }
+}
+
+static void freeAtlasPages(PreparedSpriteAtlas &prepared)
+{
+    for (SDL_Surface *page : prepared.pages)
+    {
+        SDL_FreeSurface(page);
+    }
+    prepared.pages.clear();
+}
+
+// Shelf packing: tallest first, fill rows left to right
+static int packSprites(std::vector<PackedSprite *> &order, int width, int maxHeight)
+{
+    std::stable_sort(order.begin(), order.end(), [](const PackedSprite *a, const PackedSprite *b) {
+        return a->rect.h > b->rect.h;
+    });
+
+    int penX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+
+    for (auto *sprite : order)
+    {
+        int w = sprite->rect.w + ATLAS_PADDING;
+        int h = sprite->rect.h + ATLAS_PADDING;
+        if (w > width)
+        {
+            continue;
+        }
+
+        if (penX + w > width)
+        {
+            shelfY += shelfHeight;
+            penX = 0;
+            shelfHeight = 0;
+        }
+        if (shelfY + h > maxHeight)
+        {
+            continue;
+        }
+
+        sprite->rect.x = penX;
+        sprite->rect.y = shelfY;
+        sprite->placed = true;
+        penX += w;
+        shelfHeight = SDL_max(shelfHeight, h);
+    }
+
+    return shelfY + shelfHeight;
+}
+
+bool prepareSpriteAtlas(const char *directory, int maxWidth, int maxHeight, PreparedSpriteAtlas &prepared)
+{
+    PROFILE_ZONE("prepareSpriteAtlas");
+    std::vector<std::string> paths;
+    listAssets(directory, paths);
+
+    // Sprites are named by their PNG, a pre-decoded .rgba stands in for it
+    std::vector<std::string> names;
+    for (const std::string &path : paths)
+    {
+        if (hasExtension(path, ".png"))
+        {
+            names.push_back(path);
+        }
+        else if (hasExtension(path, RAW_SPRITE_EXTENSION))
+        {
+            names.push_back(path.substr(0, path.size() - strlen(RAW_SPRITE_EXTENSION)) + ".png");
+        }
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    Uint64 loadStart = SDL_GetPerformanceCounter();
+    prepared.preDecoded = 0;
+    std::vector<PackedSprite> sprites;
+    for (const std::string &name : names)
+    {
+        SpritePixels pixels;
+        if (!loadSpritePixels(name.c_str(), pixels))
+        {
+            continue;
+        }
+
+        PackedSprite sprite;
+        sprite.path = name;
+        sprite.surface = pixels.surface;
+        sprite.drawWidth = pixels.drawWidth;
+        sprite.drawHeight = pixels.drawHeight;
+        prepared.preDecoded += pixels.preDecoded;
+        sprite.rect.w = sprite.surface->w;
+        sprite.rect.h = sprite.surface->h;
+        sprites.push_back(sprite);
+    }
+    prepared.loadMs = (SDL_GetPerformanceCounter() - loadStart) * 1000.0 / SDL_GetPerformanceFrequency();
+
+    if (sprites.empty())
+    {
+        return false;
+    }
+
+    // Fill pages until every sprite has a place
+    std::vector<PackedSprite *> remaining;
+    for (auto &sprite : sprites)
+    {
+        remaining.push_back(&sprite);
+    }
+    prepared.regions.clear();
+    freeAtlasPages(prepared);
+    while (!remaining.empty())
+    {
+        // No wider than the sprites left laid side by side
+        int rowWidth = 0;
+        for (auto *sprite : remaining)
+        {
+            rowWidth += sprite->rect.w + ATLAS_PADDING;
+        }
+        int width = SDL_min(rowWidth, maxWidth);
+        int height = packSprites(remaining, width, maxHeight);
+
+        // A sprite bigger than a whole page gets a page of its own
+        bool placedAny = std::any_of(remaining.begin(), remaining.end(), [](const PackedSprite *sprite) {
+            return sprite->placed;
+        });
+        if (!placedAny)
+        {
+            PackedSprite *sprite = remaining.front();
+            printf("Sprite atlas: %s is larger than a %dx%d page, it gets one of its own\n", sprite->path.c_str(), maxWidth, maxHeight);
+            sprite->rect.x = 0;
+            sprite->rect.y = 0;
+            sprite->placed = true;
+            width = sprite->rect.w;
+            height = sprite->rect.h;
+        }
+
+        SDL_Surface *page = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+        if (page == nullptr)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Unable to create sprite atlas surface! SDL Error: %s\n", SDL_GetError());
+            freeSurfaces(sprites);
+            freeAtlasPages(prepared);
+            return false;
+        }
+
+        int pageIndex = static_cast<int>(prepared.pages.size());
+        for (auto *sprite : remaining)
+        {
+            if (!sprite->placed)
+            {
+                continue;
+            }
+            SDL_SetSurfaceBlendMode(sprite->surface, SDL_BLENDMODE_NONE);
+            SDL_Rect destination = sprite->rect;
+            SDL_BlitSurface(sprite->surface, nullptr, page, &destination);
+            prepared.regions.push_back({sprite->path, pageIndex, sprite->rect, sprite->drawWidth, sprite->drawHeight});
+        }
+        prepared.pages.push_back(page);
+
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [](const PackedSprite *sprite) {
+            return sprite->placed;
+        }), remaining.end());
+    }
+    freeSurfaces(sprites);
+    return true;
+}
+
+bool uploadSpriteAtlas(SDL_Renderer *renderer, PreparedSpriteAtlas &prepared)
+{
+    if (!atlasPages.empty() || prepared.pages.empty())
+    {
+        freeAtlasPages(prepared);
+        return !atlasPages.empty();
+    }
+
+    PROFILE_ZONE("uploadSpriteAtlas");
+    Uint64 uploadStart = SDL_GetPerformanceCounter();
+    bool uploaded = true;
+    int totalBytes = 0;
+
+    // Indexed like prepared.pages, nullptr where the upload failed
+    std::vector<SDL_Texture *> textures;
+    for (SDL_Surface *surface : prepared.pages)
+    {
+        SDL_Texture *texture = createSpriteTexture(renderer, surface);
+        textures.push_back(texture);
+        if (texture == nullptr)
+        {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Unable to create %dx%d sprite atlas page! SDL Error: %s\n", surface->w, surface->h, SDL_GetError());
+            uploaded = false;
+            continue;
+        }
+        countTextureUpload(surface->w, surface->h);
+        atlasPages.push_back({texture, surface->w, surface->h});
+        totalBytes += surface->w * surface->h * 4;
+    }
+    double uploadMs = (SDL_GetPerformanceCounter() - uploadStart) * 1000.0 / SDL_GetPerformanceFrequency();
+
+    for (const auto &region : prepared.regions)
+    {
+        SDL_Surface *page = prepared.pages[region.page];
+        if (textures[region.page] != nullptr)
+        {
+            registerAtlasImage(region.path.c_str(), textures[region.page], region.rect, region.drawWidth, region.drawHeight, page->w, page->h);
+        }
+    }
+
+    // Compare runs with and without the .rgba files to see what pre-decoding saves
+    SDL_Log("Sprite atlas: %d sprites (%d pre-decoded) packed into %d page(s), %d KB, load %.2f ms, upload %.2f ms",
+            static_cast<int>(prepared.regions.size()), prepared.preDecoded, static_cast<int>(prepared.pages.size()), totalBytes / 1024,
+            prepared.loadMs, uploadMs);
+    freeAtlasPages(prepared);
+    return uploaded;
+}
+
+void spriteAtlasLimits(SDL_Renderer *renderer, int &maxWidth, int &maxHeight)
+{
+    SDL_RendererInfo info;
+    maxWidth = ATLAS_MAX_SIZE;
+    maxHeight = ATLAS_MAX_SIZE;
+    if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0)
+    {
+        maxWidth = SDL_min(maxWidth, info.max_texture_width);
+        maxHeight = SDL_min(maxHeight, info.max_texture_height);
+    }
+}
+
+bool buildSpriteAtlas(SDL_Renderer *renderer, const char *directory)
+{
+    if (!atlasPages.empty())
+    {
+        return true;
+    }
+
+    int maxWidth, maxHeight;
+    spriteAtlasLimits(renderer, maxWidth, maxHeight);
+    PreparedSpriteAtlas prepared;
+    return prepareSpriteAtlas(directory, maxWidth, maxHeight, prepared) && uploadSpriteAtlas(renderer, prepared);
+}
+
+void destroySpriteAtlas()
+{
+    for (const AtlasPage &page : atlasPages)
+    {
+        SDL_DestroyTexture(page.texture);
+        countTextureRelease(page.width, page.height);
+    }
+    atlasPages.clear();
+}
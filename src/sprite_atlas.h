@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+// Packs every PNG in a directory into atlas pages at startup and registers
+// each one with the texture cache as "<directory>/<file>", so loadSprite()
+// hands out atlas regions and the sprite batch can draw them in one call per
+// page. Usually everything fits on the first page; whatever doesn't goes on
+// further pages, so every sprite is uploaded here and none later.
+
+bool buildSpriteAtlas(SDL_Renderer *renderer, const char *directory);
+
+// The same in two halves for loading in the background. Preparing decodes and
+// packs the sprites into a surface and may run on any thread; uploading makes
+// the texture and registers the regions, on the render thread.
+
+struct AtlasRegion {
+    std::string path;
+    int page;           // index into PreparedSpriteAtlas::pages
+    SDL_Rect rect;
+    int drawWidth, drawHeight;
+};
+
+struct PreparedSpriteAtlas {
+    std::vector<SDL_Surface *> pages;
+    std::vector<AtlasRegion> regions;
+    int preDecoded = 0;
+    double loadMs = 0.0;
+};
+
+// Largest atlas the renderer takes, query before preparing off-thread
+void spriteAtlasLimits(SDL_Renderer *renderer, int &maxWidth, int &maxHeight);
+
+bool prepareSpriteAtlas(const char *directory, int maxWidth, int maxHeight, PreparedSpriteAtlas &prepared);
+
+// Frees prepared.pages, false if any page failed to upload
+bool uploadSpriteAtlas(SDL_Renderer *renderer, PreparedSpriteAtlas &prepared);
+
+// Call after clearTextureCache(), the cache hands out regions of these textures
+void destroySpriteAtlas();
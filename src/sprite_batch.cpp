@@ -0,0 +1,89 @@
+#include "sprite_batch.h"
+#include "texture_cache.h"
+#include "profiler.h"
+#include <algorithm>
+#include <vector>
+
+struct QueuedSprite {
+    SDL_Texture *texture;
+    SDL_Rect destination;
+    float u0, v0, u1, v1;
+};
+
+static SpriteBatchStats stats = {0, 0};
+
+// Reused between frames so a warmed up batch doesn't allocate
+static std::vector<QueuedSprite> queued;
+static std::vector<SDL_Vertex> vertices;
+static std::vector<int> indices;
+
+void queueSprite(const SpriteImage *image, const SDL_Rect &destination)
+{
+    if (image == nullptr || image->texture == nullptr) // not uploaded yet
+    {
+        return;
+    }
+    queued.push_back({image->texture, destination, image->u0, image->v0, image->u1, image->v1});
+}
+
+static void drawRun(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    if (indices.empty())
+    {
+        return;
+    }
+    SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()));
+    stats.drawCalls++;
+    vertices.clear();
+    indices.clear();
+}
+
+void flushSpriteBatch(SDL_Renderer *renderer)
+{
+    PROFILE_ZONE("flushSpriteBatch");
+    stats.sprites = static_cast<int>(queued.size());
+    stats.drawCalls = 0;
+
+    // Group by texture, stable so overlapping sprites on one texture keep their order
+    std::stable_sort(queued.begin(), queued.end(), [](const QueuedSprite &a, const QueuedSprite &b) {
+        return a.texture < b.texture;
+    });
+
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Texture *runTexture = nullptr;
+
+    for (const auto &sprite : queued)
+    {
+        if (sprite.texture != runTexture)
+        {
+            drawRun(renderer, runTexture);
+            runTexture = sprite.texture;
+        }
+
+        float x0 = static_cast<float>(sprite.destination.x);
+        float y0 = static_cast<float>(sprite.destination.y);
+        float x1 = x0 + sprite.destination.w;
+        float y1 = y0 + sprite.destination.h;
+
+        int base = static_cast<int>(vertices.size());
+        vertices.push_back({{x0, y0}, white, {sprite.u0, sprite.v0}});
+        vertices.push_back({{x1, y0}, white, {sprite.u1, sprite.v0}});
+        vertices.push_back({{x1, y1}, white, {sprite.u1, sprite.v1}});
+        vertices.push_back({{x0, y1}, white, {sprite.u0, sprite.v1}});
+
+        indices.push_back(base);
+        indices.push_back(base + 1);
+        indices.push_back(base + 2);
+        indices.push_back(base);
+        indices.push_back(base + 2);
+        indices.push_back(base + 3);
+    }
+    drawRun(renderer, runTexture);
+
+    queued.clear();
+}
+
+SpriteBatchStats getSpriteBatchStats()
+{
+    return stats;
+}
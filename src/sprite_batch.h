@@ -0,0 +1,20 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+struct SpriteImage;
+
+// Collects the frame's sprites and draws them with one SDL_RenderGeometry
+// call per texture. Sprites on the same texture keep the order they were
+// queued in; with everything in the sprite atlas that is one call per frame.
+
+void queueSprite(const SpriteImage *image, const SDL_Rect &destination);
+
+void flushSpriteBatch(SDL_Renderer *renderer);
+
+struct SpriteBatchStats {
+    int sprites;    // quads submitted by the last flush
+    int drawCalls;  // SDL_RenderGeometry calls made by the last flush
+};
+
+SpriteBatchStats getSpriteBatchStats();
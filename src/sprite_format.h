@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+// Pre-decoded sprites written by tools/convert_sprites.cpp, loaded in place
+// of the PNG with the same name ("sprites/celery.png" -> "sprites/celery.rgba").
+// All integers are little endian.
+//
+//   RawSpriteHeader
+//   width * height pixels, 4 bytes each in R, G, B, A order, rows top to
+//   bottom, colour premultiplied by alpha
+
+const char RAW_SPRITE_MAGIC[4] = {'N', 'C', 'S', 'P'};
+const uint32_t RAW_SPRITE_VERSION = 1;
+const char RAW_SPRITE_EXTENSION[] = ".rgba";
+const uint32_t RAW_SPRITE_MAX_SIZE = 8192;  // largest width or height, the Wii U's texture limit
+
+struct RawSpriteHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;         // pixels stored
+    uint32_t height;
+    uint32_t drawWidth;     // size the sprite is drawn at, the PNG's size even when the pixels were scaled down
+    uint32_t drawHeight;
+    uint32_t reserved[2];
+};
@@ -0,0 +1,30 @@
+#include "steering.h"
+#include <cmath>
+
+void steerVelocity(SteeringBehavior behavior, float dx, float dy, float &hv, float &vv)
+{
+    if (behavior != STEER_SEEK)
+    {
+        return;
+    }
+
+    int wantX = steeringSign(dx);
+    int wantY = dy > 0.0f ? 1 : -1;
+
+    // Reverse a component that is moving in the wrong direction
+    if (wantX * steeringSign(hv) < 0)
+    {
+        hv = -hv;
+    }
+    if (wantY * steeringSign(vv) < 0)
+    {
+        vv = -vv;
+    }
+}
+
+void followDirection(float dirX, float dirY, float &hv, float &vv)
+{
+    float speed = std::sqrt(hv * hv + vv * vv);
+    hv = dirX * speed;
+    vv = dirY * speed;
+}
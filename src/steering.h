@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// Per-entity movement behaviours. Everything here works on signs and enum
+// values, so steering any number of entities never allocates.
+
+enum SteeringBehavior : Uint8 {
+    STEER_NONE,     // keep going, bounce off the edges
+    STEER_SEEK,     // turn towards a target
+    STEER_ORBIT,    // circle a target, positions come from orbitEntities()
+    STEER_FOLLOW    // head along a flow field direction
+};
+
+// -1, 0 or 1
+inline int steeringSign(float value)
+{
+    return (value > 0.0f) - (value < 0.0f);
+}
+
+// Seek keeps the speed and flips whichever velocity component points
+// the wrong way. dx, dy go from the steered object to its target. A vertical
+// tie counts as the target being above, as the game always did.
+void steerVelocity(SteeringBehavior behavior, float dx, float dy, float &hv, float &vv);
+
+// Follow keeps the speed and turns the velocity to the unit direction dirX, dirY
+void followDirection(float dirX, float dirY, float &hv, float &vv);
+
+// Protecting enemies seek their token until they are within orbitRange of it
+inline SteeringBehavior protectorBehavior(float distance, float orbitRange)
+{
+    return distance >= orbitRange ? STEER_SEEK : STEER_ORBIT;
+}
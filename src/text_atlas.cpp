@@ -0,0 +1,194 @@
+#include "text_atlas.h"
+#include "profiler.h"
+#include <vector>
+
+const int FIRST_GLYPH = 32;  // space
+const int LAST_GLYPH = 126;  // ~
+const int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+const int ATLAS_COLUMNS = 16;
+
+struct GlyphAtlas {
+    SDL_Texture *texture = nullptr;
+    int width = 0;
+    int height = 0;
+    int lineHeight = 0;
+    SDL_Rect glyphs[GLYPH_COUNT] = {};
+    int advance[GLYPH_COUNT] = {};
+};
+
+static GlyphAtlas atlas;
+
+static int glyphIndex(unsigned char c)
+{
+    if (c < FIRST_GLYPH || c > LAST_GLYPH)
+    {
+        return '?' - FIRST_GLYPH;
+    }
+    return c - FIRST_GLYPH;
+}
+
+bool buildGlyphAtlas(SDL_Renderer *renderer, TTF_Font *font)
+{
+    if (font == nullptr)
+    {
+        printf("Glyph atlas needs a font: %s\n", TTF_GetError());
+        return false;
+    }
+
+    destroyGlyphAtlas();
+
+    PROFILE_ZONE("buildGlyphAtlas");
+    SDL_Surface *glyphSurfaces[GLYPH_COUNT] = {};
+    int cellWidth = 0;
+    int cellHeight = 0;
+    SDL_Color white = {255, 255, 255, 255};
+
+    for (int i = 0; i < GLYPH_COUNT; i++)
+    {
+        Uint16 ch = static_cast<Uint16>(FIRST_GLYPH + i);
+        TTF_GlyphMetrics(font, ch, nullptr, nullptr, nullptr, nullptr, &atlas.advance[i]);
+        glyphSurfaces[i] = TTF_RenderGlyph_Blended(font, ch, white);
+        if (glyphSurfaces[i] != nullptr)
+        {
+            cellWidth = SDL_max(cellWidth, glyphSurfaces[i]->w);
+            cellHeight = SDL_max(cellHeight, glyphSurfaces[i]->h);
+        }
+    }
+
+    atlas.lineHeight = SDL_max(cellHeight, TTF_FontHeight(font));
+    atlas.width = cellWidth * ATLAS_COLUMNS;
+    atlas.height = cellHeight * ((GLYPH_COUNT + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS);
+
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, atlas.width, atlas.height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (surface == nullptr)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Unable to create glyph atlas surface! SDL Error: %s\n", SDL_GetError());
+        for (auto *glyphSurface : glyphSurfaces)
+        {
+            SDL_FreeSurface(glyphSurface);
+        }
+        return false;
+    }
+
+    for (int i = 0; i < GLYPH_COUNT; i++)
+    {
+        SDL_Rect &cell = atlas.glyphs[i];
+        cell.x = (i % ATLAS_COLUMNS) * cellWidth;
+        cell.y = (i / ATLAS_COLUMNS) * cellHeight;
+        cell.w = 0;
+        cell.h = 0;
+
+        if (glyphSurfaces[i] == nullptr)
+        {
+            continue;
+        }
+
+        // Copy alpha as is instead of blending onto the empty atlas
+        SDL_SetSurfaceBlendMode(glyphSurfaces[i], SDL_BLENDMODE_NONE);
+        cell.w = glyphSurfaces[i]->w;
+        cell.h = glyphSurfaces[i]->h;
+        SDL_Rect destination = cell;
+        SDL_BlitSurface(glyphSurfaces[i], nullptr, surface, &destination);
+        SDL_FreeSurface(glyphSurfaces[i]);
+    }
+
+    atlas.texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    if (atlas.texture == nullptr)
+    {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Unable to create glyph atlas texture! SDL Error: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+
+    return true;
+}
+
+bool glyphAtlasReady()
+{
+    return atlas.texture != nullptr;
+}
+
+void measureAtlasText(const char *text, int *width, int *height)
+{
+    int textWidth = 0;
+    for (const char *c = text; *c != '\0'; c++)
+    {
+        textWidth += atlas.advance[glyphIndex(static_cast<unsigned char>(*c))];
+    }
+
+    if (width != nullptr)
+    {
+        *width = textWidth;
+    }
+    if (height != nullptr)
+    {
+        *height = atlas.lineHeight;
+    }
+}
+
+void buildAtlasTextGeometry(const char *text, int x, int y, SDL_Color color, std::vector<SDL_Vertex> &vertices, std::vector<int> &indices)
+{
+    vertices.clear();
+    indices.clear();
+    if (atlas.texture == nullptr)
+    {
+        return;
+    }
+
+    // Same as SDL_ttf, a zero alpha means opaque
+    if (color.a == 0)
+    {
+        color.a = 255;
+    }
+
+    float invWidth = 1.0f / atlas.width;
+    float invHeight = 1.0f / atlas.height;
+    float penX = static_cast<float>(x);
+    float penY = static_cast<float>(y);
+
+    for (const char *c = text; *c != '\0'; c++)
+    {
+        int glyph = glyphIndex(static_cast<unsigned char>(*c));
+        const SDL_Rect &cell = atlas.glyphs[glyph];
+
+        if (cell.w > 0 && *c != ' ')
+        {
+            float u0 = cell.x * invWidth;
+            float v0 = cell.y * invHeight;
+            float u1 = (cell.x + cell.w) * invWidth;
+            float v1 = (cell.y + cell.h) * invHeight;
+            float x1 = penX + cell.w;
+            float y1 = penY + cell.h;
+
+            int base = static_cast<int>(vertices.size());
+            vertices.push_back({{penX, penY}, color, {u0, v0}});
+            vertices.push_back({{x1, penY}, color, {u1, v0}});
+            vertices.push_back({{x1, y1}, color, {u1, v1}});
+            vertices.push_back({{penX, y1}, color, {u0, v1}});
+
+            indices.push_back(base);
+            indices.push_back(base + 1);
+            indices.push_back(base + 2);
+            indices.push_back(base);
+            indices.push_back(base + 2);
+            indices.push_back(base + 3);
+        }
+
+        penX += atlas.advance[glyph];
+    }
+}
+
+void drawAtlasGeometry(SDL_Renderer *renderer, const std::vector<SDL_Vertex> &vertices, const std::vector<int> &indices)
+{
+    if (atlas.texture != nullptr && !indices.empty())
+    {
+        SDL_RenderGeometry(renderer, atlas.texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()));
+    }
+}
+
+void destroyGlyphAtlas()
+{
+    SDL_DestroyTexture(atlas.texture);
+    atlas = GlyphAtlas();
+}
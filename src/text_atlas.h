@@ -0,0 +1,24 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <vector>
+
+// Printable ASCII glyphs rasterized once into a single texture.
+// Text is drawn as one batch of textured quads per string, so drawing the HUD
+// doesn't create any surfaces or textures.
+
+bool buildGlyphAtlas(SDL_Renderer *renderer, TTF_Font *font);
+
+bool glyphAtlasReady();
+
+// Width and height in pixels of a string drawn with the atlas
+void measureAtlasText(const char *text, int *width, int *height);
+
+// Quads for text with its top left corner at x, y. Callers keep them between
+// frames. Replaces the contents of vertices and indices.
+void buildAtlasTextGeometry(const char *text, int x, int y, SDL_Color color, std::vector<SDL_Vertex> &vertices, std::vector<int> &indices);
+
+void drawAtlasGeometry(SDL_Renderer *renderer, const std::vector<SDL_Vertex> &vertices, const std::vector<int> &indices);
+
+void destroyGlyphAtlas();
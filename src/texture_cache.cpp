@@ -0,0 +1,298 @@
+#include "texture_cache.h"
+#include "profiler.h"
+#include "raw_sprite.h"
+#include <string>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct CachedImage {
+    SpriteImage image = {};
+    int refCount = 0;
+    size_t bytes = 0;       // 0 for atlas regions, the atlas page is counted once
+    bool ownsTexture = false;
+    std::string path;
+    SDL_Surface *pending = nullptr; // pixels waiting for the render thread to upload
+    bool released = false;          // in releasedImages, waiting for releasedAt to be drawn
+    Uint64 releasedAt = 0;
+};
+
+static std::atomic<int> textureCount(0);
+static std::atomic<size_t> textureBytes(0);
+static std::atomic<Uint32> uploadCount(0);
+
+// Guards everything below, the simulation thread acquires and releases while
+// the render thread uploads and destroys
+static std::mutex cacheMutex;
+
+// path -> entry, plus a reverse index so releasing is a single lookup
+static std::unordered_map<std::string, CachedImage> imagesByPath;
+static std::unordered_map<const SpriteImage *, CachedImage *> imagesByHandle;
+
+// Entries updateTextureCache() has to look at, reused so it doesn't allocate
+static std::vector<CachedImage *> pendingImages;
+static std::vector<CachedImage *> releasedImages;
+
+static std::thread::id renderThread;
+static Uint64 releaseTick = 0;
+
+static CachedImage &insertImage(const char *filePath, SDL_Texture *texture, const SDL_Rect &source, int drawWidth, int drawHeight, int textureWidth, int textureHeight)
+{
+    CachedImage &entry = imagesByPath[filePath];
+    entry.image.texture = texture;
+    entry.image.source = source;
+    entry.image.width = drawWidth;
+    entry.image.height = drawHeight;
+    entry.image.u0 = static_cast<float>(source.x) / textureWidth;
+    entry.image.v0 = static_cast<float>(source.y) / textureHeight;
+    entry.image.u1 = static_cast<float>(source.x + source.w) / textureWidth;
+    entry.image.v1 = static_cast<float>(source.y + source.h) / textureHeight;
+    entry.path = filePath;
+    imagesByHandle[&entry.image] = &entry;
+    return entry;
+}
+
+static void countUpload(size_t bytes)
+{
+    textureCount.fetch_add(1, std::memory_order_relaxed);
+    textureBytes.fetch_add(bytes, std::memory_order_relaxed);
+    uploadCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void countRelease(size_t bytes)
+{
+    textureCount.fetch_sub(1, std::memory_order_relaxed);
+    textureBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+// Lookup key reused between calls, so a cache hit doesn't allocate a string
+static std::string lookupKey;
+
+// Take a reference on filePath if it is cached, caller holds cacheMutex
+static const SpriteImage *findImage(const char *filePath)
+{
+    lookupKey.assign(filePath);
+    auto found = imagesByPath.find(lookupKey);
+    if (found == imagesByPath.end())
+    {
+        return nullptr;
+    }
+    found->second.refCount++;
+    return &found->second.image;
+}
+
+void setTextureCacheRenderThread()
+{
+    renderThread = std::this_thread::get_id();
+}
+
+const SpriteImage *acquireImage(SDL_Renderer *renderer, const char *filePath)
+{
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        const SpriteImage *image = findImage(filePath);
+        if (image != nullptr)
+        {
+            return image;
+        }
+    }
+
+    // Decode without holding the lock, the render thread keeps drawing meanwhile
+    PROFILE_ZONE("loadTexture");
+    SpritePixels pixels;
+    if (!loadSpritePixels(filePath, pixels))
+    {
+        return nullptr;
+    }
+    int width = pixels.surface->w;
+    int height = pixels.surface->h;
+    bool onRenderThread = std::this_thread::get_id() == renderThread;
+    SDL_Texture *texture = nullptr;
+    if (onRenderThread)
+    {
+        texture = createSpriteTexture(renderer, pixels.surface);
+        SDL_FreeSurface(pixels.surface);
+        pixels.surface = nullptr;
+        if (texture == nullptr)
+        {
+            printf("Failed to create texture for %s! SDL Error: %s\n", filePath, SDL_GetError());
+            return nullptr;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    const SpriteImage *raced = findImage(filePath);
+    if (raced != nullptr)
+    {
+        // Another thread loaded it meanwhile
+        SDL_FreeSurface(pixels.surface);
+        if (texture != nullptr)
+        {
+            SDL_DestroyTexture(texture);
+        }
+        return raced;
+    }
+
+    CachedImage &entry = insertImage(filePath, texture, SDL_Rect{0, 0, width, height}, pixels.drawWidth, pixels.drawHeight, width, height);
+    entry.refCount = 1;
+    entry.ownsTexture = true;
+    entry.bytes = static_cast<size_t>(width) * height * 4;
+    if (onRenderThread)
+    {
+        countUpload(entry.bytes);
+    }
+    else
+    {
+        entry.pending = pixels.surface;
+        pendingImages.push_back(&entry);
+    }
+
+    return &entry.image;
+}
+
+// Drop an entry whose texture no snapshot can reach any more, caller holds cacheMutex
+static void destroyImage(CachedImage *entry)
+{
+    if (entry->pending != nullptr)
+    {
+        SDL_FreeSurface(entry->pending);
+    }
+    else if (entry->ownsTexture && entry->image.texture != nullptr)
+    {
+        countRelease(entry->bytes);
+        SDL_DestroyTexture(entry->image.texture);
+    }
+    imagesByHandle.erase(&entry->image);
+    imagesByPath.erase(imagesByPath.find(entry->path));
+}
+
+void releaseImage(const SpriteImage *image)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto found = imagesByHandle.find(image);
+    if (found == imagesByHandle.end())
+    {
+        return;
+    }
+
+    CachedImage *entry = found->second;
+    if (--entry->refCount > 0)
+    {
+        return;
+    }
+
+    // The snapshots before the one being computed may still draw it
+    entry->releasedAt = releaseTick;
+    if (!entry->released)
+    {
+        entry->released = true;
+        releasedImages.push_back(entry);
+    }
+}
+
+void setTextureReleaseTick(Uint64 tick)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    releaseTick = tick;
+}
+
+void updateTextureCache(SDL_Renderer *renderer, Uint64 drawnTick)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (CachedImage *entry : pendingImages)
+    {
+        entry->image.texture = createSpriteTexture(renderer, entry->pending);
+        if (entry->image.texture == nullptr)
+        {
+            printf("Failed to create texture for %s! SDL Error: %s\n", entry->path.c_str(), SDL_GetError());
+        }
+        else
+        {
+            countUpload(entry->bytes);
+        }
+        SDL_FreeSurface(entry->pending);
+        entry->pending = nullptr;
+    }
+    pendingImages.clear();
+
+    size_t kept = 0;
+    for (CachedImage *entry : releasedImages)
+    {
+        if (entry->refCount > 0)
+        {
+            entry->released = false; // acquired again
+        }
+        else if (entry->releasedAt > drawnTick)
+        {
+            releasedImages[kept++] = entry;
+        }
+        else
+        {
+            destroyImage(entry);
+        }
+    }
+    releasedImages.resize(kept);
+}
+
+void registerAtlasImage(const char *filePath, SDL_Texture *texture, const SDL_Rect &source, int drawWidth, int drawHeight, int textureWidth, int textureHeight)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto found = imagesByPath.find(filePath);
+    if (found != imagesByPath.end())
+    {
+        printf("Sprite %s is already loaded, not moving it into the atlas\n", filePath);
+        return;
+    }
+
+    CachedImage &entry = insertImage(filePath, texture, source, drawWidth, drawHeight, textureWidth, textureHeight);
+    entry.refCount = 1; // held by the cache itself
+    entry.ownsTexture = false;
+}
+
+TextureCacheStats getTextureCacheStats()
+{
+    TextureCacheStats current;
+    current.textures = textureCount.load(std::memory_order_relaxed);
+    current.bytes = textureBytes.load(std::memory_order_relaxed);
+    current.uploads = uploadCount.load(std::memory_order_relaxed);
+    return current;
+}
+
+Uint32 textureUploadCount()
+{
+    return uploadCount.load(std::memory_order_relaxed);
+}
+
+void countTextureUpload(int width, int height)
+{
+    countUpload(static_cast<size_t>(width) * height * 4);
+}
+
+void countTextureRelease(int width, int height)
+{
+    countRelease(static_cast<size_t>(width) * height * 4);
+}
+
+void clearTextureCache()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (auto &pair : imagesByPath)
+    {
+        CachedImage &entry = pair.second;
+        if (entry.pending != nullptr)
+        {
+            SDL_FreeSurface(entry.pending);
+        }
+        else if (entry.ownsTexture && entry.image.texture != nullptr)
+        {
+            SDL_DestroyTexture(entry.image.texture);
+            countRelease(entry.bytes);
+        }
+    }
+    imagesByHandle.clear();
+    imagesByPath.clear();
+    pendingImages.clear();
+    releasedImages.clear();
+}
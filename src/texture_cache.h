@@ -0,0 +1,64 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+// Shared, reference counted sprite images keyed by asset path.
+// An image is either its own texture or a region of the sprite atlas.
+// Every acquireImage() must be balanced by a releaseImage(); an image's own
+// texture is destroyed once its last user has released it and no snapshot the
+// renderer may still draw refers to it.
+//
+// Textures are only ever created and destroyed on the render thread. Any
+// other thread (the simulation) gets an image whose texture is still null
+// until the next updateTextureCache() uploads it, and its releases are
+// deferred to updateTextureCache() as well.
+
+struct SpriteImage {
+    SDL_Texture *texture;   // own texture or the atlas page the image lives on
+    SDL_Rect source;        // pixels of texture covered by the image
+    float u0, v0, u1, v1;   // source as normalized texture coordinates
+    int width, height;      // size to draw at, larger than source for pre-scaled sprites
+};
+
+// Call once from the render thread before anything else uses the cache
+void setTextureCacheRenderThread();
+
+// Size and texture coordinates are valid right away. On the render thread
+// the texture is too; elsewhere it is uploaded by the next updateTextureCache().
+const SpriteImage *acquireImage(SDL_Renderer *renderer, const char *filePath);
+
+void releaseImage(const SpriteImage *image);
+
+// Simulation side: releases from now on happen while computing the snapshot
+// for tick, and any earlier snapshot may still show the image
+void setTextureReleaseTick(Uint64 tick);
+
+// Render thread, once per frame after picking up the snapshot for drawnTick.
+// Uploads images acquired on other threads and destroys the textures released
+// at or before drawnTick that nobody acquired again since.
+void updateTextureCache(SDL_Renderer *renderer, Uint64 drawnTick);
+
+// Make filePath resolve to a region of an atlas texture. The cache keeps one
+// reference itself so atlas images are never unloaded; the atlas owns texture.
+// drawWidth/drawHeight is the size the sprite is drawn at.
+void registerAtlasImage(const char *filePath, SDL_Texture *texture, const SDL_Rect &source, int drawWidth, int drawHeight, int textureWidth, int textureHeight);
+
+struct TextureCacheStats {
+    int textures;       // textures currently alive
+    size_t bytes;       // estimated texture memory (RGBA8 width * height * 4)
+    Uint32 uploads;     // decodes + uploads since boot, should stop growing once warm
+};
+
+TextureCacheStats getTextureCacheStats();
+
+// Same as getTextureCacheStats().uploads. Stats are atomic, any thread may read them.
+Uint32 textureUploadCount();
+
+// Account for a texture created and destroyed outside the cache (atlas pages)
+void countTextureUpload(int width, int height);
+
+void countTextureRelease(int width, int height);
+
+// Destroys every cached texture regardless of reference counts (shutdown only,
+// after the simulation thread has stopped)
+void clearTextureCache();
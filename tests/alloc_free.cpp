@@ -0,0 +1,139 @@
+// The enemy pass is meant to run without touching the heap once its scratch
+// is reserved. This runs the game's own updateEnemies() (src/enemy_update.cpp)
+// for every modifier combination, with token orbits, enemy-vs-enemy bounces,
+// a hunter flow field and angry timers on, the same way updateGame() does. It
+// fails on any operator new call during the pass, on any thread.
+//
+//   make -f Makefile.host test
+
+#include "../src/alloc_counter.h"
+#include "../src/enemy_update.h"
+#include "../src/job_system.h"
+#include <stdio.h>
+#include <vector>
+
+const int ENEMIES = 4000;   // divisible by 4, the game only protects tokens then
+const int TOKENS = 5;
+const int TICKS = 200;
+
+struct alignas(64) CacheLine
+{
+    char bytes[64];
+};
+
+// Keeps the compiler from leaving out a new/delete pair it can see through
+static void *volatile escaped;
+
+static void fillStore(EntityStore &store, int count)
+{
+    reserveEntities(store, count);
+    for (int i = 0; i < count; i++)
+    {
+        Sprite sprite = {};
+        sprite.fx = static_cast<float>((i * 37) % SCREEN_WIDTH);
+        sprite.fy = static_cast<float>((i * 53) % SCREEN_HEIGHT);
+        sprite.hv = 120.0f + i % 120;
+        sprite.vv = -120.0f - i % 90;
+        sprite.bounds = {static_cast<int>(sprite.fx), static_cast<int>(sprite.fy), 30, 30};
+        sprite.angle = 0.0f;
+        sprite.evilTimer = i % 3 == 0 ? 900 : 0;
+        addEntity(store, sprite);
+    }
+}
+
+// Allocations made by updateEnemies<Hunter, AngryCelery>() over TICKS ticks
+template <bool Hunter, bool AngryCelery>
+static Uint64 runTicks()
+{
+    EntityStore enemies;
+    EntityStore tokens;
+    fillStore(enemies, ENEMIES);
+    fillStore(tokens, TOKENS);
+
+    // Consecutive enemies protect the same token, as in updateOrbitAssignments()
+    std::vector<int> orbitTokenForEnemy(ENEMIES);
+    for (int i = 0; i < ENEMIES; i++)
+    {
+        orbitTokenForEnemy[i] = i * TOKENS / ENEMIES;
+    }
+
+    FlowField hunterField;
+    initFlowField(hunterField, SCREEN_WIDTH, SCREEN_HEIGHT);
+    float targetX[] = {SCREEN_WIDTH / 2.0f};
+    float targetY[] = {SCREEN_HEIGHT / 2.0f};
+    buildFlowField(hunterField, targetX, targetY, 1);
+
+    SpatialGrid enemyGrid;
+    initSpatialGrid(enemyGrid, SCREEN_WIDTH, SCREEN_HEIGHT);
+    EnemyScratch scratch;
+
+    EnemyPass pass;
+    pass.enemies = &enemies;
+    pass.tokens = &tokens;
+    pass.orbitTokenForEnemy = orbitTokenForEnemy.data();
+    pass.hunterField = &hunterField;
+    pass.bounceGrid = &enemyGrid;
+    pass.scratch = &scratch;
+    pass.deltaTime = SIM_TICK;
+
+    Uint64 allocated = 0;
+    for (int tick = 0; tick <= TICKS; tick++)
+    {
+        // What updateGame() does around the pass
+        reserveEnemyScratch(scratch, ENEMIES, 4 * 200); // 4 * MAX_ENEMIES in main.cpp
+        reserveBounceCandidates(scratch, ENEMIES, enemyGrid);
+
+        Uint64 before = allocationCount();
+        updateEnemies<Hunter, AngryCelery>(pass);
+        if (tick > 0) // the first tick still sizes the job queues
+        {
+            allocated += allocationCount() - before;
+        }
+
+        for (int i = 0; i < enemies.count; i++)
+        {
+            updateSpatialGridItem(enemyGrid, i, entityBounds(enemies, i));
+        }
+    }
+    return allocated;
+}
+
+int main()
+{
+    int failures = 0;
+    if (!ALLOCATION_COUNTING)
+    {
+        printf("FAILED: built without NCES_COUNT_ALLOCATIONS, nothing is counted\n");
+        return 1;
+    }
+
+    // The counter has to see both plain and over-aligned allocations
+    Uint64 before = allocationCount();
+    int *plain = new int(1);
+    escaped = plain;
+    CacheLine *aligned = new CacheLine();
+    escaped = aligned;
+    if (allocationCount() - before != 2 || reinterpret_cast<uintptr_t>(aligned) % alignof(CacheLine) != 0)
+    {
+        printf("FAILED: operator new isn't counted\n");
+        failures++;
+    }
+    delete plain;
+    delete aligned;
+
+    startJobSystem(2);
+    Uint64 counts[] = {runTicks<false, false>(), runTicks<false, true>(), runTicks<true, false>(), runTicks<true, true>()};
+    const char *names[] = {"plain", "angry", "hunter", "hunter + angry"};
+    stopJobSystem();
+
+    for (int i = 0; i < 4; i++)
+    {
+        printf("%-16s %d ticks of %d enemies: %llu allocations\n", names[i], TICKS, ENEMIES, static_cast<unsigned long long>(counts[i]));
+        if (counts[i] != 0)
+        {
+            printf("FAILED: the enemy pass allocated\n");
+            failures++;
+        }
+    }
+    return failures > 0 ? 1 : 0;
+}
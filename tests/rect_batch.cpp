@@ -0,0 +1,94 @@
+// intersectRectBatch() against SDL_HasIntersection on random rects: small
+// ones so plenty overlap, empty and negative sizes, shared edges, and counts
+// that don't fill the last mask word or the last vector.
+//
+//   make -f Makefile.host test
+
+#include "../src/random.h"
+#include "../src/rect_batch.h"
+#include <stdio.h>
+#include <vector>
+
+const int ROUNDS = 2000;
+
+static SDL_Rect randomRect()
+{
+    SDL_Rect rect;
+    rect.x = randomInt(RNG_SPAWN, -20, 100);
+    rect.y = randomInt(RNG_SPAWN, -20, 100);
+    rect.w = randomInt(RNG_SPAWN, -5, 40);
+    rect.h = randomInt(RNG_SPAWN, -5, 40);
+    return rect;
+}
+
+int main()
+{
+    seedRandom(1234);
+    int failures = 0;
+    int hitsTotal = 0;
+
+    std::vector<int> x, y, w, h;
+    std::vector<Uint32> hits;
+    for (int round = 0; round < ROUNDS && failures < 10; round++)
+    {
+        int count = randomInt(RNG_SIZE, 0, 100);
+        x.resize(count);
+        y.resize(count);
+        w.resize(count);
+        h.resize(count);
+        // Poison the mask so words the kernel should clear are checked too
+        hits.assign(rectBatchWords(count), 0xdeadbeef);
+
+        SDL_Rect rect = randomRect();
+        for (int i = 0; i < count; i++)
+        {
+            SDL_Rect other = randomRect();
+            if (i % 7 == 0)
+            {
+                other.x = rect.x + rect.w; // touching the right edge, not overlapping
+            }
+            x[i] = other.x;
+            y[i] = other.y;
+            w[i] = other.w;
+            h[i] = other.h;
+        }
+
+        int hitCount = intersectRectBatch(rect, x.data(), y.data(), w.data(), h.data(), count, hits.data());
+        int expectedCount = 0;
+        for (int i = 0; i < count; i++)
+        {
+            SDL_Rect other = {x[i], y[i], w[i], h[i]};
+            bool expected = SDL_HasIntersection(&rect, &other) == SDL_TRUE;
+            bool got = (hits[i / 32] >> (i % 32)) & 1;
+            expectedCount += expected;
+            if (expected != got)
+            {
+                printf("FAILED: {%d,%d,%d,%d} vs {%d,%d,%d,%d}: SDL says %d, the batch %d\n", rect.x, rect.y, rect.w, rect.h,
+                       other.x, other.y, other.w, other.h, expected, got);
+                failures++;
+            }
+        }
+        if (count % 32 != 0 && (hits.back() >> (count % 32)) != 0)
+        {
+            printf("FAILED: bits past the last rect are set\n");
+            failures++;
+        }
+        if (hitCount != expectedCount)
+        {
+            printf("FAILED: returned %d hits, there are %d\n", hitCount, expectedCount);
+            failures++;
+        }
+
+        int visited = 0;
+        forEachHit(hits.data(), count, [&](int) { visited++; });
+        if (visited != expectedCount)
+        {
+            printf("FAILED: forEachHit() visited %d hits, there are %d\n", visited, expectedCount);
+            failures++;
+        }
+        hitsTotal += hitCount;
+    }
+
+    printf("%d rounds, %d hits, %d mismatches\n", ROUNDS, hitsTotal, failures);
+    return failures > 0 ? 1 : 0;
+}
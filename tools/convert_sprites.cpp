@@ -0,0 +1,135 @@
+// Converts PNG sprites to the pre-decoded format in src/sprite_format.h, so
+// the game uploads them without decoding anything at load time.
+//
+//   nces-sprites [--scale F] romfs/sprites/*.png
+//
+// Each sprite is written next to its PNG with a .rgba extension. --scale
+// stores the pixels at F times the size (0 < F <= 1) while the sprite is still
+// drawn at its original size, for sprites much larger than they end up on screen.
+
+#include "../src/sprite_format.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static void putLE32(unsigned char *out, uint32_t value)
+{
+    out[0] = static_cast<unsigned char>(value & 0xFF);
+    out[1] = static_cast<unsigned char>((value >> 8) & 0xFF);
+    out[2] = static_cast<unsigned char>((value >> 16) & 0xFF);
+    out[3] = static_cast<unsigned char>((value >> 24) & 0xFF);
+}
+
+static std::string outputPath(const std::string &pngPath)
+{
+    size_t dot = pngPath.find_last_of('.');
+    return (dot == std::string::npos ? pngPath : pngPath.substr(0, dot)) + RAW_SPRITE_EXTENSION;
+}
+
+static bool convertSprite(const char *pngPath, float scale)
+{
+    SDL_Surface *loaded = IMG_Load(pngPath);
+    if (loaded == nullptr)
+    {
+        printf("Failed to load %s: %s\n", pngPath, IMG_GetError());
+        return false;
+    }
+    SDL_Surface *source = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (source == nullptr)
+    {
+        return false;
+    }
+
+    // Premultiplied before scaling, so filtering never bleeds the colour of transparent pixels
+    SDL_PremultiplyAlpha(source->w, source->h, SDL_PIXELFORMAT_RGBA32, source->pixels, source->pitch,
+                         SDL_PIXELFORMAT_RGBA32, source->pixels, source->pitch);
+
+    int drawWidth = source->w;
+    int drawHeight = source->h;
+    if (drawWidth > static_cast<int>(RAW_SPRITE_MAX_SIZE) || drawHeight > static_cast<int>(RAW_SPRITE_MAX_SIZE))
+    {
+        // The game refuses anything bigger
+        printf("%s is %dx%d, larger than %u pixels\n", pngPath, drawWidth, drawHeight, static_cast<unsigned>(RAW_SPRITE_MAX_SIZE));
+        SDL_FreeSurface(source);
+        return false;
+    }
+    SDL_Surface *pixels = source;
+    if (scale < 1.0f)
+    {
+        int width = SDL_max(1, static_cast<int>(drawWidth * scale + 0.5f));
+        int height = SDL_max(1, static_cast<int>(drawHeight * scale + 0.5f));
+        pixels = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+        if (pixels == nullptr || SDL_SoftStretchLinear(source, nullptr, pixels, nullptr) != 0)
+        {
+            printf("Failed to scale %s: %s\n", pngPath, SDL_GetError());
+            SDL_FreeSurface(source);
+            SDL_FreeSurface(pixels);
+            return false;
+        }
+        SDL_FreeSurface(source);
+    }
+
+    unsigned char header[sizeof(RawSpriteHeader)] = {};
+    memcpy(header, RAW_SPRITE_MAGIC, sizeof(RAW_SPRITE_MAGIC));
+    putLE32(header + 4, RAW_SPRITE_VERSION);
+    putLE32(header + 8, static_cast<uint32_t>(pixels->w));
+    putLE32(header + 12, static_cast<uint32_t>(pixels->h));
+    putLE32(header + 16, static_cast<uint32_t>(drawWidth));
+    putLE32(header + 20, static_cast<uint32_t>(drawHeight));
+
+    std::string path = outputPath(pngPath);
+    FILE *file = fopen(path.c_str(), "wb");
+    bool written = file != nullptr && fwrite(header, sizeof(header), 1, file) == 1;
+    for (int y = 0; written && y < pixels->h; y++)
+    {
+        const unsigned char *row = static_cast<const unsigned char *>(pixels->pixels) + y * pixels->pitch;
+        written = fwrite(row, static_cast<size_t>(pixels->w) * 4, 1, file) == 1;
+    }
+    if (file != nullptr)
+    {
+        written = fclose(file) == 0 && written;
+    }
+    if (!written)
+    {
+        printf("Failed to write %s\n", path.c_str());
+    }
+    else
+    {
+        printf("%s: %dx%d drawn at %dx%d\n", path.c_str(), pixels->w, pixels->h, drawWidth, drawHeight);
+    }
+    SDL_FreeSurface(pixels);
+    return written;
+}
+
+int main(int argc, char **argv)
+{
+    float scale = 1.0f;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "--scale") == 0)
+    {
+        scale = static_cast<float>(atof(argv[2]));
+        first = 3;
+    }
+    if (first >= argc || scale <= 0.0f || scale > 1.0f)
+    {
+        printf("Usage: %s [--scale F] SPRITE.png...\n", argv[0]);
+        return 1;
+    }
+
+    if (IMG_Init(IMG_INIT_PNG) == 0)
+    {
+        printf("SDL_image could not initialize: %s\n", IMG_GetError());
+        return 1;
+    }
+    int failed = 0;
+    for (int i = first; i < argc; i++)
+    {
+        failed += !convertSprite(argv[i], scale);
+    }
+    IMG_Quit();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+// Packs every file under an asset directory into one archive the game can map
+// at startup, see src/archive_format.h for the layout.
+//
+//   nces-pack romfs romfs/assets.pak
+
+#include "../src/archive_format.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct PackedFile {
+    std::string path;   // relative, '/' separated
+    std::vector<char> data;
+    uint32_t pathOffset = 0;
+    uint32_t dataOffset = 0;
+};
+
+static void putLE32(std::vector<char> &out, size_t at, uint32_t value)
+{
+    out[at] = static_cast<char>(value & 0xFF);
+    out[at + 1] = static_cast<char>((value >> 8) & 0xFF);
+    out[at + 2] = static_cast<char>((value >> 16) & 0xFF);
+    out[at + 3] = static_cast<char>((value >> 24) & 0xFF);
+}
+
+static bool readFile(const fs::path &path, std::vector<char> &data)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        printf("Usage: %s ASSET_DIR ARCHIVE\n", argv[0]);
+        return 1;
+    }
+    fs::path root = argv[1];
+    fs::path archivePath = argv[2];
+
+    std::vector<PackedFile> files;
+    std::error_code error;
+    for (auto it = fs::recursive_directory_iterator(root, error); !error && it != fs::recursive_directory_iterator(); it.increment(error))
+    {
+        if (!it->is_regular_file() || it->path().filename() == ARCHIVE_NAME)
+        {
+            continue;
+        }
+        PackedFile file;
+        file.path = it->path().lexically_relative(root).generic_string();
+        if (!readFile(it->path(), file.data))
+        {
+            printf("Failed to read %s\n", it->path().c_str());
+            return 1;
+        }
+        files.push_back(std::move(file));
+    }
+    if (error)
+    {
+        printf("Failed to scan %s: %s\n", root.c_str(), error.message().c_str());
+        return 1;
+    }
+
+    // The game binary searches the table with strcmp
+    std::sort(files.begin(), files.end(), [](const PackedFile &a, const PackedFile &b) {
+        return a.path < b.path;
+    });
+
+    size_t offset = sizeof(ArchiveHeader) + files.size() * sizeof(ArchiveEntry);
+    for (auto &file : files)
+    {
+        file.pathOffset = static_cast<uint32_t>(offset);
+        offset += file.path.size() + 1;
+    }
+    for (auto &file : files)
+    {
+        offset = (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+        file.dataOffset = static_cast<uint32_t>(offset);
+        offset += file.data.size();
+    }
+    if (offset > UINT32_MAX)
+    {
+        printf("Archive would be larger than 4 GB\n");
+        return 1;
+    }
+
+    std::vector<char> out(offset, 0);
+    std::copy(ARCHIVE_MAGIC, ARCHIVE_MAGIC + 4, out.begin());
+    putLE32(out, 4, ARCHIVE_VERSION);
+    putLE32(out, 8, static_cast<uint32_t>(files.size()));
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        const PackedFile &file = files[i];
+        size_t entry = sizeof(ArchiveHeader) + i * sizeof(ArchiveEntry);
+        putLE32(out, entry, file.pathOffset);
+        putLE32(out, entry + 4, file.dataOffset);
+        putLE32(out, entry + 8, static_cast<uint32_t>(file.data.size()));
+        std::copy(file.path.begin(), file.path.end(), out.begin() + file.pathOffset);
+        std::copy(file.data.begin(), file.data.end(), out.begin() + file.dataOffset);
+    }
+
+    std::ofstream archive(archivePath, std::ios::binary | std::ios::trunc);
+    if (!archive.write(out.data(), static_cast<std::streamsize>(out.size())))
+    {
+        printf("Failed to write %s\n", archivePath.c_str());
+        return 1;
+    }
+    printf("Packed %zu files into %s, %zu KB\n", files.size(), archivePath.c_str(), out.size() / 1024);
+    return 0;
+}